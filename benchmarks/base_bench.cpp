@@ -1,9 +1,13 @@
 #include "common.h"
+#include <algorithm>
 #include <ctime>
 #include <random>
+#include <thread>
+#include <vector>
 #include <hwy/contrib/algo/copy-inl.h>
 #include <hwy/contrib/algo/find-inl.h>
 #include <hwy/highway.h>
+#include <lcrypt/aes128.h>
 #include <lcrypt/base.h>
 
 namespace hn = hwy::HWY_NAMESPACE;
@@ -43,3 +47,161 @@ static void bench_random(bench::Bench& b) {
 }
 
 BENCHMARK_REGISTE(bench_random);
+
+static void bench_random_threads(bench::Bench& b) {
+    static constexpr size_t times = 1 << 20;
+    const unsigned ncpu           = std::max(1u, std::thread::hardware_concurrency());
+
+    // total draws per second, flat per thread when it scales with cores
+    b.title("random threads");
+    for (unsigned n = 1; n <= ncpu; n *= 2) {
+        b.batch(times * n).run("random x" + std::to_string(n), [&] {
+            std::vector<std::thread> threads;
+            for (unsigned t = 0; t < n; t++) {
+                threads.emplace_back([] {
+                    double sum = 0;
+                    for (size_t i = 0; i < times; i++) {
+                        sum += lc::random();
+                    }
+                    bench::doNotOptimizeAway(sum);
+                });
+            }
+            for (auto& th : threads) {
+                th.join();
+            }
+        });
+    }
+    b.batch(1);
+}
+
+BENCHMARK_REGISTE(bench_random_threads);
+
+static void bench_random_bulk(bench::Bench& b) {
+    static constexpr size_t n = 1 << 16;
+    std::vector<double> ds(n);
+    std::vector<int64_t> is(n);
+    std::vector<uint8_t> bytes(n * 8);
+
+    b.title("random bulk");
+    b.batch(n).run("random()", [&] {
+        for (auto& d : ds) {
+            d = lc::random();
+        }
+        bench::doNotOptimizeAway(ds.data());
+    });
+    b.batch(n).run("random_fill", [&] {
+        lc::random_fill(ds.data(), n);
+        bench::doNotOptimizeAway(ds.data());
+    });
+    b.batch(n).run("random(1000)", [&] {
+        for (auto& x : is) {
+            x = lc::random(1000);
+        }
+        bench::doNotOptimizeAway(is.data());
+    });
+    b.batch(n).run("random_uniform_ints(1000)", [&] {
+        lc::random_uniform_ints(is.data(), n, 0, 999);
+        bench::doNotOptimizeAway(is.data());
+    });
+    b.batch(n).run("random_uniform_ints(2^40)", [&] {
+        lc::random_uniform_ints(is.data(), n, 0, (int64_t)1 << 40);
+        bench::doNotOptimizeAway(is.data());
+    });
+    b.batch(n * 8).run("random_bytes", [&] {
+        lc::random_bytes(bytes.data(), bytes.size());
+        bench::doNotOptimizeAway(bytes.data());
+    });
+
+    lc::rng g(42);
+    b.batch(n).run("rng()", [&] {
+        for (auto& x : is) {
+            x = (int64_t)g();
+        }
+        bench::doNotOptimizeAway(is.data());
+    });
+    b.batch(n).run("rng::fill", [&] {
+        g.fill(ds.data(), n);
+        bench::doNotOptimizeAway(ds.data());
+    });
+    b.batch(n).run("rng::uniform_ints(1000)", [&] {
+        g.uniform_ints(is.data(), n, 0, 999);
+        bench::doNotOptimizeAway(is.data());
+    });
+    b.batch(n * 8).run("rng::bytes", [&] {
+        g.bytes(bytes.data(), bytes.size());
+        bench::doNotOptimizeAway(bytes.data());
+    });
+    b.batch(1);
+}
+
+BENCHMARK_REGISTE(bench_random_bulk);
+
+static void bench_random_sampling(bench::Bench& b) {
+    const size_t n = 4096;
+    std::vector<uint32_t> v(n);
+    b.title("random sampling");
+    b.batch(n).unit("element");
+    b.run("fisher-yates with random(m)", [&] {
+        for (size_t i = n - 1; i > 0; --i) {
+            std::swap(v[i], v[lc::random(i + 1)]);
+        }
+        bench::doNotOptimizeAway(v.data());
+    });
+    b.run("shuffle", [&] {
+        lc::shuffle(v);
+        bench::doNotOptimizeAway(v.data());
+    });
+    std::mt19937_64 mt(42);
+    b.run("std::shuffle(mt19937_64)", [&] {
+        std::shuffle(v.begin(), v.end(), mt);
+        bench::doNotOptimizeAway(v.data());
+    });
+
+    b.batch(64).run("sample_indices(1M, 64)",
+                    [&] { bench::doNotOptimizeAway(lc::sample_indices(1 << 20, 64)); });
+
+    std::vector<double> w(100);
+    for (size_t i = 0; i < w.size(); ++i) {
+        w[i] = (double)(i % 7 + 1);
+    }
+    lc::weighted_choice pick(w);
+    std::discrete_distribution<size_t> dist(w.begin(), w.end());
+    std::vector<size_t> out(n);
+    b.batch(n).unit("draw");
+    b.run("std::discrete_distribution", [&] {
+        for (auto& x : out) {
+            x = dist(mt);
+        }
+        bench::doNotOptimizeAway(out.data());
+    });
+    b.run("weighted_choice()", [&] {
+        for (auto& x : out) {
+            x = pick();
+        }
+        bench::doNotOptimizeAway(out.data());
+    });
+    b.run("weighted_choice(out, n)", [&] {
+        pick(out.data(), n);
+        bench::doNotOptimizeAway(out.data());
+    });
+    b.batch(1).unit("op");
+}
+
+BENCHMARK_REGISTE(bench_random_sampling);
+
+static void bench_secure_random(bench::Bench& b) {
+    char token[16];
+    std::vector<uint8_t> bytes(1 << 16);
+    b.title("secure random");
+    b.run("secure_random_bytes(16)", [&] {
+        lc::secure_random_bytes(token, sizeof(token));
+        bench::doNotOptimizeAway(token);
+    });
+    b.batch(bytes.size()).unit("byte").run("secure_random_bytes(64K)", [&] {
+        lc::secure_random_bytes(bytes.data(), bytes.size());
+        bench::doNotOptimizeAway(bytes.data());
+    });
+    b.batch(1).unit("op");
+}
+
+BENCHMARK_REGISTE(bench_secure_random);
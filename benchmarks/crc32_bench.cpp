@@ -0,0 +1,18 @@
+#include "common.h"
+#include <string>
+#include <lcrypt/crc32.h>
+
+using namespace lc;
+
+static void bench_crc32(bench::Bench& b) {
+    for (size_t n : {64, 1024, 65536}) {
+        const std::string data(n, 'x');
+        b.title("crc32(" + std::to_string(n) + ")");
+        b.batch(n).unit("byte");
+        b.run("crc32c", [&] { bench::doNotOptimizeAway(crc32c(data)); });
+        b.run("crc32", [&] { bench::doNotOptimizeAway(crc32(data)); });
+    }
+    b.batch(1).unit("op");
+}
+
+BENCHMARK_REGISTE(bench_crc32);
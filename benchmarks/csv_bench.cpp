@@ -0,0 +1,51 @@
+#include "common.h"
+#include <string_view>
+#include <vector>
+#include <lcrypt/csv.h>
+
+using namespace lc;
+
+// byte-at-a-time state machine
+size_t csv_count0(std::string_view data) {
+    size_t nfields = 0;
+    bool inquote   = false;
+    for (char c : data) {
+        if (c == '"') {
+            inquote = !inquote;
+        } else if (!inquote && (c == ',' || c == '\n')) {
+            ++nfields;
+        }
+    }
+    return nfields;
+}
+
+static std::string make_input() {
+    std::string row = "12345,\"Doe, John\",john.doe@example.com,\"said \"\"hello\"\"\","
+                      "2024-01-01T00:00:00Z,aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\n";
+    std::string out;
+    for (int i = 0; i < 64; ++i) {
+        out += row;
+    }
+    return out;
+}
+static const std::string input = make_input();
+
+static void bench_csv(bench::Bench& b) {
+    b.title("csv");
+    auto old = b.epochIterations();
+    b.minEpochIterations(2048);
+
+    b.run("csv::read(simd)", [&] {
+        csv_reader reader(input);
+        std::vector<std::string_view> fields;
+        size_t n = 0;
+        while (reader.next(fields)) {
+            n += fields.size();
+        }
+        bench::doNotOptimizeAway(n);
+    });
+    b.run("csv::read", [&] { bench::doNotOptimizeAway(csv_count0(input)); });
+
+    b.minEpochIterations(old);
+}
+BENCHMARK_REGISTE(bench_csv);
@@ -0,0 +1,67 @@
+#include "common.h"
+#include <string>
+#include <vector>
+#include <lcrypt/hash.h>
+
+using namespace lc;
+
+/// 64 bit FNV-1a, the scalar baseline
+static uint64_t fnv1a(const std::string_view s) {
+    uint64_t h = 0xcbf29ce484222325;
+    for (unsigned char c : s) {
+        h = (h ^ c) * 0x100000001b3;
+    }
+    return h;
+}
+
+static void bench_hash(bench::Bench& b) {
+    const siphash_key key = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+    for (size_t n : {16, 256, 65536}) {
+        const std::string data(n, 'x');
+        b.title("hash(" + std::to_string(n) + ")");
+        b.batch(n).unit("byte");
+        b.run("fnv1a", [&] { bench::doNotOptimizeAway(fnv1a(data)); });
+        b.run("hash64", [&] { bench::doNotOptimizeAway(hash64(data)); });
+        b.run("siphash13", [&] { bench::doNotOptimizeAway(siphash13(key, data)); });
+        b.run("siphash24", [&] { bench::doNotOptimizeAway(siphash24(key, data)); });
+    }
+
+    // shard keys like "user:123456"
+    const size_t n = 4096;
+    std::vector<std::string> strs(n);
+    std::vector<std::string_view> keys(n);
+    for (size_t i = 0; i < n; ++i) {
+        strs[i] = "user:" + std::to_string(i * 7919);
+        keys[i] = strs[i];
+    }
+    std::vector<uint64_t> out(n);
+    b.title("hash keys x 4096");
+    b.batch(n).unit("key");
+    b.run("fnv1a", [&] {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = fnv1a(keys[i]);
+        }
+        bench::doNotOptimizeAway(out.data());
+    });
+    b.run("hash64_batch", [&] {
+        hash64_batch(keys.data(), n, out.data());
+        bench::doNotOptimizeAway(out.data());
+    });
+    b.run("siphash13 x 4096", [&] {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = siphash13(key, keys[i]);
+        }
+        bench::doNotOptimizeAway(out.data());
+    });
+    b.run("siphash13_batch", [&] {
+        siphash13_batch(key, keys.data(), n, out.data());
+        bench::doNotOptimizeAway(out.data());
+    });
+    b.run("siphash24_batch", [&] {
+        siphash24_batch(key, keys.data(), n, out.data());
+        bench::doNotOptimizeAway(out.data());
+    });
+    b.batch(1).unit("op");
+}
+
+BENCHMARK_REGISTE(bench_hash);
@@ -0,0 +1,36 @@
+#include "common.h"
+#include <string>
+#include <vector>
+#include <lcrypt/hmac.h>
+
+using namespace lc;
+
+static void bench_hmac(bench::Bench& b) {
+    const std::string secret = "0123456789abcdef0123456789abcdef";
+    const std::string msg(100, 'm');
+    hmac_sha256_key key(secret);
+
+    b.title("hmac-sha256(100)");
+    b.run("hmac_sha256 (key each time)", [&] {
+        bench::doNotOptimizeAway(hmac_sha256(secret.data(), secret.size(), msg.data(), msg.size()));
+    });
+    b.run("hmac_sha256_key::sign", [&] { bench::doNotOptimizeAway(key.sign(msg)); });
+
+    const size_t n = 1024;
+    std::vector<std::string_view> msgs(n, std::string_view(msg));
+    std::vector<sha256::digest_t> macs(n);
+    b.batch(n).unit("msg");
+    b.run("hmac_sha256_key::sign x 1024", [&] {
+        for (size_t i = 0; i < n; ++i) {
+            macs[i] = key.sign(msgs[i]);
+        }
+        bench::doNotOptimizeAway(macs.data());
+    });
+    b.run("hmac_sha256_key::sign_batch(1024)", [&] {
+        key.sign_batch(msgs.data(), n, macs.data());
+        bench::doNotOptimizeAway(macs.data());
+    });
+    b.batch(1).unit("op");
+}
+
+BENCHMARK_REGISTE(bench_hmac);
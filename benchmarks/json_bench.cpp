@@ -0,0 +1,54 @@
+#include "common.h"
+#include <string_view>
+#include <lcrypt/json.h>
+
+using namespace lc;
+
+std::string json_escape0(std::string_view what) {
+    static const char hex[] = "0123456789abcdef";
+    std::string out;
+    for (unsigned char c : what) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\b': out += "\\b"; break;
+        case '\t': out += "\\t"; break;
+        case '\n': out += "\\n"; break;
+        case '\f': out += "\\f"; break;
+        case '\r': out += "\\r"; break;
+        default:
+            if (c < 0x20) {
+                out += "\\u00";
+                out += hex[c >> 4];
+                out += hex[c & 0xf];
+            } else {
+                out += (char)c;
+            }
+            break;
+        }
+    }
+    return out;
+}
+
+static const std::string input =
+    "{\"hello\": \"world111111111111111111111111111111111111111111111111111111111111111\","
+    "\"text\": \"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\\n"
+    "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\\t"
+    "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\","
+    "\"path\": \"c:\\\\windows\\\\system32\\\\drivers\\\\etc\\\\hosts\\\\aaaaaaaaaaaaaaaaaaaaaaa\"}"
+    "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+    "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa";
+static std::string input_escaped = json_escape(input);
+
+static void bench_json(bench::Bench& b) {
+    b.title("json");
+    auto old = b.epochIterations();
+    b.minEpochIterations(20480);
+
+    b.run("json::escape(simd)", [&] { bench::doNotOptimizeAway(json_escape(input)); });
+    b.run("json::escape", [&] { bench::doNotOptimizeAway(json_escape0(input)); });
+    b.run("json::unescape(simd)", [&] { bench::doNotOptimizeAway(json_unescape(input_escaped)); });
+
+    b.minEpochIterations(old);
+}
+BENCHMARK_REGISTE(bench_json);
@@ -0,0 +1,35 @@
+#include "common.h"
+#include <string>
+#include <vector>
+#include <lcrypt/md5.h>
+
+using namespace lc;
+
+static void bench_md5(bench::Bench& b) {
+    b.title("md5");
+    const std::string data(1024, 'x');
+    b.batch(data.size()).unit("byte").run("md5::hash(1024)",
+                                          [&] { bench::doNotOptimizeAway(md5::hash(data)); });
+
+    const size_t n = 1024;
+    std::string msgs_data(n * 40, 'y');
+    std::vector<std::string_view> msgs;
+    for (size_t i = 0; i < n; ++i) {
+        msgs.emplace_back(msgs_data.data() + i * 40, 40);
+    }
+    std::vector<md5::digest_t> out(n);
+    b.batch(n).unit("msg");
+    b.run("md5::hash x 1024 (40)", [&] {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = md5::hash(msgs[i]);
+        }
+        bench::doNotOptimizeAway(out.data());
+    });
+    b.run("md5_batch(1024, 40)", [&] {
+        md5_batch(msgs.data(), n, out.data());
+        bench::doNotOptimizeAway(out.data());
+    });
+    b.batch(1).unit("op");
+}
+
+BENCHMARK_REGISTE(bench_md5);
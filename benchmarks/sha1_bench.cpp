@@ -0,0 +1,44 @@
+#include "common.h"
+#include <string>
+#include <vector>
+#include <lcrypt/base64.h>
+#include <lcrypt/sha1.h>
+
+using namespace lc;
+
+static void bench_sha1(bench::Bench& b) {
+    b.title("sha1");
+    const std::string data(1024, 'x');
+    b.batch(data.size()).unit("byte").run("sha1::hash(1024)",
+                                          [&] { bench::doNotOptimizeAway(sha1::hash(data)); });
+
+    const std::string key = "dGhlIHNhbXBsZSBub25jZQ==258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    b.batch(1).unit("op");
+    b.run("base64_encode(sha1::hash)", [&] {
+        const auto d = sha1::hash(key);
+        bench::doNotOptimizeAway(base64_encode((const char*)d.data(), d.size()));
+    });
+    b.run("sha1_base64", [&] { bench::doNotOptimizeAway(sha1_base64(key)); });
+
+    const size_t n = 1024;
+    std::string msgs_data(n * 60, 'y');
+    std::vector<std::string_view> msgs;
+    for (size_t i = 0; i < n; ++i) {
+        msgs.emplace_back(msgs_data.data() + i * 60, 60);
+    }
+    std::vector<sha1::digest_t> out(n);
+    b.batch(n).unit("msg");
+    b.run("sha1::hash x 1024 (60)", [&] {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = sha1::hash(msgs[i]);
+        }
+        bench::doNotOptimizeAway(out.data());
+    });
+    b.run("sha1_batch(1024, 60)", [&] {
+        sha1_batch(msgs.data(), n, out.data());
+        bench::doNotOptimizeAway(out.data());
+    });
+    b.batch(1).unit("op");
+}
+
+BENCHMARK_REGISTE(bench_sha1);
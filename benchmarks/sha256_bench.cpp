@@ -0,0 +1,40 @@
+#include "common.h"
+#include <string>
+#include <vector>
+#include <lcrypt/sha256.h>
+
+using namespace lc;
+
+static void bench_sha256(bench::Bench& b) {
+    b.title("sha256");
+    for (size_t len : {64, 1024, 65536}) {
+        const std::string data(len, 'x');
+        b.batch(len).unit("byte").run("sha256::hash(" + std::to_string(len) + ")",
+                                      [&] { bench::doNotOptimizeAway(sha256::hash(data)); });
+    }
+
+    // many small messages, one at a time against a lane each
+    for (size_t len : {32, 200}) {
+        const size_t n = 1024;
+        std::string data(n * len, 'y');
+        std::vector<std::string_view> msgs;
+        for (size_t i = 0; i < n; ++i) {
+            msgs.emplace_back(data.data() + i * len, len);
+        }
+        std::vector<sha256::digest_t> out(n);
+        b.batch(n).unit("msg");
+        b.run("sha256::hash x 1024 (" + std::to_string(len) + ")", [&] {
+            for (size_t i = 0; i < n; ++i) {
+                out[i] = sha256::hash(msgs[i]);
+            }
+            bench::doNotOptimizeAway(out.data());
+        });
+        b.run("sha256_batch(1024, " + std::to_string(len) + ")", [&] {
+            sha256_batch(msgs.data(), n, out.data());
+            bench::doNotOptimizeAway(out.data());
+        });
+    }
+    b.batch(1).unit("op");
+}
+
+BENCHMARK_REGISTE(bench_sha256);
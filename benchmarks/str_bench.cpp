@@ -93,6 +93,14 @@ static void bench_string(bench::Bench& b) {
           [&] { bench::doNotOptimizeAway(lc::str_toupper("aabcdefghijklabcdefghijklbcdefgh0abcdefghijklabc")); });
     b.run("tolower", [&] { bench::doNotOptimizeAway(str_tolower0(input)); });
     b.run("tolower(simd)", [&] { bench::doNotOptimizeAway(lc::str_tolower(input)); });
+    b.run("iequals", [&] {
+        bench::doNotOptimizeAway(str_tolower0(input) == str_tolower0(input_sv.substr(0)));
+    });
+    b.run("iequals(simd)", [&] { bench::doNotOptimizeAway(lc::str_iequals(input, input_sv)); });
+    b.run("ifind(simd)", [&] { bench::doNotOptimizeAway(lc::str_ifind(input, "AAAA,")); });
+    b.run("ihash(simd)", [&] { bench::doNotOptimizeAway(lc::str_ihash(input)); });
+    b.run("utf8_validate(simd)", [&] { bench::doNotOptimizeAway(lc::utf8_validate(input)); });
+    b.run("utf8_to_utf16(simd)", [&] { bench::doNotOptimizeAway(lc::utf8_to_utf16(input)); });
     b.run("split", [&] { bench::doNotOptimizeAway(lc::str_split(input, ",")); });
     b.run("join", [&] { bench::doNotOptimizeAway(lc::str_join(splitted, ",")); });
 
@@ -100,3 +108,224 @@ static void bench_string(bench::Bench& b) {
 }
 
 BENCHMARK_REGISTE(bench_string);
+
+static void bench_pack(bench::Bench& b) {
+    static constexpr std::string_view fmt = "<!4 I4 H i8 c8 s2 d b";
+    const lc::pack_format pf(fmt);
+    const auto packed = lc::str_pack(fmt, 42, 7, -1, "ticker", "payload", 3.25, 1);
+    b.title("pack");
+    auto old = b.epochIterations();
+    b.minEpochIterations(102400);
+    b.run("str_pack", [&] {
+        bench::doNotOptimizeAway(lc::str_pack(fmt, 42, 7, -1, "ticker", "payload", 3.25, 1));
+    });
+    b.run("pack_format::pack", [&] {
+        bench::doNotOptimizeAway(pf.pack(42, 7, -1, "ticker", "payload", 3.25, 1));
+    });
+    b.run("str_pack_into", [&] {
+        char buf[128];
+        bench::doNotOptimizeAway(
+            lc::str_pack_into(buf, sizeof(buf), fmt, 42, 7, -1, "ticker", "payload", 3.25, 1));
+    });
+    b.run("pack_format::pack_into", [&] {
+        char buf[128];
+        bench::doNotOptimizeAway(pf.pack_into(buf, sizeof(buf), 42, 7, -1, "ticker", "payload", 3.25, 1));
+    });
+    b.run("str_pack<fmt>::pack_into", [&] {
+        char buf[128];
+        bench::doNotOptimizeAway(lc::str_pack_into<"<!4 I4 H i8 c8 s2 d b">(
+            buf, sizeof(buf), 42, 7, -1, "ticker", "payload", 3.25, 1));
+    });
+    b.run("str_unpack", [&] {
+        bench::doNotOptimizeAway(
+            lc::str_unpack<uint32_t, uint16_t, int64_t, std::string, std::string, double, int8_t>(fmt, packed));
+    });
+    b.run("pack_format::unpack", [&] {
+        bench::doNotOptimizeAway(
+            pf.unpack<uint32_t, uint16_t, int64_t, std::string, std::string, double, int8_t>(packed));
+    });
+    b.minEpochIterations(old);
+}
+
+BENCHMARK_REGISTE(bench_pack);
+
+static void bench_pack_array(bench::Bench& b) {
+    struct tick {
+        uint32_t id;
+        double price;
+        int64_t qty;
+    };
+    static constexpr size_t n = 100000;
+    const lc::pack_format pf(">I4 d i8");
+    std::vector<tick> ticks(n);
+    for (size_t i = 0; i < n; ++i) {
+        ticks[i] = {(uint32_t)i, i * 0.01, (int64_t)i * 100};
+    }
+    const auto packed = pf.pack_array(ticks.data(), n, &tick::id, &tick::price, &tick::qty);
+    const std::string_view data(packed.data(), packed.size());
+    std::vector<uint32_t> ids(n);
+    std::vector<double> prices(n);
+    std::vector<int64_t> qtys(n);
+    b.title("pack_array");
+    b.run("pack_format::unpack loop", [&] {
+        const size_t rs = pf.record_size();
+        for (size_t i = 0; i < n; ++i) {
+            auto [id, price, qty, _] = pf.unpack<uint32_t, double, int64_t>(data.substr(i * rs, rs));
+            ticks[i]                 = {id, price, qty};
+        }
+        bench::doNotOptimizeAway(ticks);
+    });
+    b.run("unpack_array(aos)", [&] {
+        bench::doNotOptimizeAway(
+            pf.unpack_array(data, ticks.data(), n, &tick::id, &tick::price, &tick::qty));
+    });
+    b.run("unpack_array(soa)", [&] {
+        bench::doNotOptimizeAway(pf.unpack_array(data, n, ids.data(), prices.data(), qtys.data()));
+    });
+    b.run("pack_array(aos)", [&] {
+        bench::doNotOptimizeAway(pf.pack_array(ticks.data(), n, &tick::id, &tick::price, &tick::qty));
+    });
+    b.run("pack_array(soa)", [&] {
+        bench::doNotOptimizeAway(pf.pack_array(n, ids.data(), prices.data(), qtys.data()));
+    });
+}
+
+BENCHMARK_REGISTE(bench_pack_array);
+
+static void bench_varint(bench::Bench& b) {
+    static constexpr size_t n = 100000;
+    std::vector<uint64_t> values(n);
+    for (size_t i = 0; i < n; ++i) {
+        values[i] = (i % 4 == 0) ? (uint64_t)i * 2654435761u : i % 100;
+    }
+    const auto encoded = lc::varint_encode(values.data(), n);
+    std::vector<uint64_t> out(n);
+    std::vector<char> buf(10 * n);
+    b.title("varint");
+    b.run("varint_decode", [&] {
+        size_t i = 0, k = 0;
+        while (i < encoded.size()) {
+            i += lc::detail::varint_read(encoded.data() + i, encoded.size() - i, out[k++]);
+        }
+        bench::doNotOptimizeAway(out);
+    });
+    b.run("varint_decode(simd)", [&] { bench::doNotOptimizeAway(lc::varint_decode(encoded, out.data())); });
+    // 1 and 2 byte varints only, decoded with the shuffle table
+    std::vector<uint64_t> small(n);
+    for (size_t i = 0; i < n; ++i) {
+        small[i] = (i * 2654435761u >> 7) % ((i % 3 == 0) ? 16384 : 128);
+    }
+    const auto encsmall = lc::varint_encode(small.data(), n);
+    b.run("varint_decode(1-2 bytes)", [&] {
+        size_t i = 0, k = 0;
+        while (i < encsmall.size()) {
+            i += lc::detail::varint_read(encsmall.data() + i, encsmall.size() - i, out[k++]);
+        }
+        bench::doNotOptimizeAway(out);
+    });
+    b.run("varint_decode(simd, 1-2 bytes)", [&] {
+        bench::doNotOptimizeAway(lc::varint_decode(encsmall, out.data()));
+    });
+    b.run("varint_encode", [&] {
+        size_t pos = 0;
+        for (auto v : values) {
+            pos += lc::detail::varint_write(buf.data() + pos, v);
+        }
+        bench::doNotOptimizeAway(pos);
+    });
+    b.run("varint_encode(simd)", [&] {
+        bench::doNotOptimizeAway(lc::varint_encode(values.data(), n, buf.data()));
+    });
+}
+
+BENCHMARK_REGISTE(bench_varint);
+
+static void bench_pack_aggregate(bench::Bench& b) {
+    struct quote {
+        uint32_t id;
+        int16_t side;
+        std::array<char, 2> venue;
+        double price;
+        int64_t qty;
+    };
+    const quote q       = {7, -1, {'N', 'Y'}, 101.5, -300};
+    const auto packed   = lc::pack(q);
+    const auto packedbe = lc::pack(q, ">");
+    const std::string_view venue(q.venue.data(), q.venue.size());
+    b.title("pack aggregate");
+    auto old = b.epochIterations();
+    b.minEpochIterations(102400);
+    b.run("str_pack", [&] {
+        bench::doNotOptimizeAway(
+            lc::str_pack("=!i4 i2 c2 d i8", q.id, q.side, venue, q.price, q.qty));
+    });
+    b.run("pack", [&] { bench::doNotOptimizeAway(lc::pack(q)); });
+    b.run("pack(>)", [&] { bench::doNotOptimizeAway(lc::pack(q, ">")); });
+    b.run("unpack", [&] {
+        bench::doNotOptimizeAway(lc::unpack<quote>(std::string_view(packed.data(), packed.size())));
+    });
+    b.run("unpack(>)", [&] {
+        bench::doNotOptimizeAway(
+            lc::unpack<quote>(std::string_view(packedbe.data(), packedbe.size()), ">"));
+    });
+    b.minEpochIterations(old);
+}
+
+BENCHMARK_REGISTE(bench_pack_aggregate);
+
+static void bench_pack_reader(bench::Bench& b) {
+    lc::pack_format pf("<I4 d S z");
+    auto m = pf.pack(7, 101.5, std::string(40, 'a'), "venue");
+    const std::string_view msg(m.data(), m.size());
+    // whole, cut in two inside the S string, and in 8 byte pieces
+    std::vector<std::string_view> pieces;
+    for (size_t i = 0; i < msg.size(); i += 8) {
+        pieces.push_back(msg.substr(i, 8));
+    }
+    uint32_t id;
+    double price;
+    std::string_view s, z;
+    b.title("pack reader");
+    auto old = b.epochIterations();
+    b.minEpochIterations(102400);
+    b.run("pack_format::unpack", [&] {
+        bench::doNotOptimizeAway(pf.unpack<uint32_t, double, std::string_view, std::string_view>(msg));
+    });
+    b.run("pack_reader(1)", [&] {
+        lc::pack_reader rd(pf);
+        rd.feed(msg);
+        bench::doNotOptimizeAway(rd.unpack(id, price, s, z));
+    });
+    b.run("pack_reader(2)", [&] {
+        lc::pack_reader rd(pf);
+        rd.feed(msg.substr(0, 20));
+        rd.feed(msg.substr(20));
+        bench::doNotOptimizeAway(rd.unpack(id, price, s, z));
+    });
+    b.run("pack_reader(8B)", [&] {
+        lc::pack_reader rd(pf);
+        rd.feed(pieces.data(), pieces.size());
+        bench::doNotOptimizeAway(rd.unpack(id, price, s, z));
+    });
+    b.minEpochIterations(old);
+}
+
+BENCHMARK_REGISTE(bench_pack_reader);
+
+static void bench_unpack_values(bench::Bench& b) {
+    lc::pack_format pf("<i4 I8 d s2 z");
+    const auto m = pf.pack(-5, 1234567, 101.5, "quote", "venue");
+    const std::string_view msg(m.data(), m.size());
+    std::vector<lc::pack_value> vs;
+    b.title("unpack values");
+    auto old = b.epochIterations();
+    b.minEpochIterations(102400);
+    b.run("pack_format::unpack", [&] {
+        bench::doNotOptimizeAway(
+            pf.unpack<int, uint64_t, double, std::string_view, std::string_view>(msg));
+    });
+    b.run("unpack_values", [&] { bench::doNotOptimizeAway(lc::unpack_values(pf, msg, vs)); });
+    b.minEpochIterations(old);
+}
+
+BENCHMARK_REGISTE(bench_unpack_values);
@@ -0,0 +1,41 @@
+#include "common.h"
+#include <lcrypt/aes128.h>
+#include <lcrypt/base64.h>
+#include <lcrypt/hex.h>
+#include <lcrypt/token.h>
+
+using namespace lc;
+
+static void bench_token(bench::Bench& b) {
+    char raw[16];
+    b.title("random token(16)");
+    b.run("secure_random_bytes + hex_encode", [&] {
+        secure_random_bytes(raw, sizeof(raw));
+        bench::doNotOptimizeAway(hex_encode(raw, sizeof(raw)));
+    });
+    b.run("random_token_hex", [&] { bench::doNotOptimizeAway(random_token_hex(16)); });
+    b.run("secure_random_bytes + base64_encode", [&] {
+        secure_random_bytes(raw, sizeof(raw));
+        bench::doNotOptimizeAway(base64_encode(raw, sizeof(raw)));
+    });
+    b.run("random_token_base64url", [&] { bench::doNotOptimizeAway(random_token_base64url(16)); });
+
+    const size_t count = 1024;
+    b.batch(count).unit("token");
+    b.run("1024 x random_token_hex", [&] {
+        for (size_t i = 0; i < count; ++i) {
+            bench::doNotOptimizeAway(random_token_hex(16));
+        }
+    });
+    b.run("random_tokens_hex(1024)", [&] { bench::doNotOptimizeAway(random_tokens_hex(count, 16)); });
+    b.run("1024 x random_token_base64url", [&] {
+        for (size_t i = 0; i < count; ++i) {
+            bench::doNotOptimizeAway(random_token_base64url(16));
+        }
+    });
+    b.run("random_tokens_base64url(1024)",
+          [&] { bench::doNotOptimizeAway(random_tokens_base64url(count, 16)); });
+    b.batch(1).unit("op");
+}
+
+BENCHMARK_REGISTE(bench_token);
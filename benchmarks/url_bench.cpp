@@ -0,0 +1,47 @@
+#include "common.h"
+#include <string_view>
+#include <ctype.h>
+#include <lcrypt/url.h>
+
+using namespace lc;
+
+std::string url_encode0(std::string_view what) {
+    static const char hex[] = "0123456789ABCDEF";
+    std::string out;
+    for (unsigned char c : what) {
+        if (isalnum(c) || c == '-' || c == '.' || c == '_' || c == '~') {
+            out += (char)c;
+        } else {
+            out += '%';
+            out += hex[c >> 4];
+            out += hex[c & 0xf];
+        }
+    }
+    return out;
+}
+
+static const std::string input =
+    "https://example.com/search/aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+    "?q=hello world&lang=zh-CN&text=\xE4\xB8\xAD\xE6\x96\x87&page=1&"
+    "token=abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz0123456789";
+static std::string input_encoded = url_encode(input);
+static const std::string query =
+    "q=hello+world&lang=zh-CN&text=%E4%B8%AD%E6%96%87&page=1&size=20&sort=desc&"
+    "token=abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz0123456789";
+
+static void bench_url(bench::Bench& b) {
+    b.title("url");
+    auto old = b.epochIterations();
+    b.minEpochIterations(20480);
+
+    b.run("url::encode(simd)", [&] { bench::doNotOptimizeAway(url_encode(input)); });
+    b.run("url::encode", [&] { bench::doNotOptimizeAway(url_encode0(input)); });
+    b.run("url::decode(simd)", [&] { bench::doNotOptimizeAway(url_decode(input_encoded)); });
+    b.run("url::parse_query(simd)", [&] {
+        std::string buf;
+        bench::doNotOptimizeAway(url_parse_query(query, buf));
+    });
+
+    b.minEpochIterations(old);
+}
+BENCHMARK_REGISTE(bench_url);
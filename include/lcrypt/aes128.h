@@ -1,5 +1,6 @@
 #pragma once
 
+#include <string_view>
 #include <vector>
 #include <lcrypt/base.h>
 #include <stdint.h>
@@ -28,4 +29,42 @@ aes128_dec(const Tp& plain, const Tk& key) {
     return aes128_dec(p.data(), p.size(), k.data(), k.size());
 }
 
+/// NIST SP 800-90A CTR_DRBG with AES-128, no derivation function and no prediction
+/// resistance: the entropy input is the full 32 byte seed.
+class ctr_drbg {
+public:
+    static constexpr size_t kSeedLen          = 32;
+    static constexpr size_t kMaxRequest       = 1 << 16; /* bytes per generate() */
+    static constexpr uint64_t kReseedInterval = 1 << 20; /* generate() calls */
+
+    /// Seeded from the OS
+    ctr_drbg();
+    /// `entropy` has kSeedLen bytes, `personalization` at most kSeedLen
+    explicit ctr_drbg(const uint8_t* entropy, std::string_view personalization = {});
+    ~ctr_drbg();
+
+    ctr_drbg(const ctr_drbg&)            = delete;
+    ctr_drbg& operator=(const ctr_drbg&) = delete;
+
+    /// From the OS
+    void reseed();
+    void reseed(const uint8_t* entropy, std::string_view additional = {});
+
+    /// Throws once reseed_counter() passes kReseedInterval
+    void generate(void* out, size_t n);
+
+    uint64_t reseed_counter() const { return reseed_counter_; }
+
+private:
+    void instantiate(const uint8_t* entropy, std::string_view personalization);
+
+    uint8_t key_[16];
+    uint8_t v_[16];
+    uint64_t reseed_counter_;
+};
+
+/// For keys, IVs and tokens. A ctr_drbg per thread seeded from the OS, reseeded after
+/// kReseedInterval requests and in the child of a fork().
+void secure_random_bytes(void* buf, size_t n);
+
 }  // namespace lc
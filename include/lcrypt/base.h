@@ -4,6 +4,8 @@
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <utility>
+#include <vector>
 #include <stdint.h>
 #include <stdio.h>
 
@@ -65,7 +67,11 @@ public:
     }
 };
 
+/// a[0, n) == b[0, n) in a time that depends only on `n`, for MACs and tokens
+bool constant_time_equal(const void* a, const void* b, size_t n);
+
 // rand
+// Thread safe, every thread draws from its own stream.
 
 /// [0, 1)
 double random();
@@ -74,4 +80,147 @@ size_t random(size_t m);
 /// [m, n]
 size_t random(size_t m, size_t n);
 
+// Bulk versions, written straight from the vector generator
+
+void random_bytes(void* buf, size_t n);
+/// [0, 1)
+void random_fill(double* out, size_t n);
+/// [lo, hi], uniform without bias
+void random_uniform_ints(int64_t* out, size_t n, int64_t lo, int64_t hi);
+
+/// 64 bits from the OS: getrandom(), arc4random or std::random_device on Windows.
+/// Log it to replay a run with rng(seed).
+uint64_t random_seed();
+
+class rng;
+
+namespace detail {
+/// out[k] uniform in [0, top - k] for k < n <= top + 1, the swap partners of a Fisher-Yates
+/// pass going down from `top`
+void shuffle_draws(uint64_t* out, size_t n, uint64_t top);
+void shuffle_draws(rng& g, uint64_t* out, size_t n, uint64_t top);
+/// The stream of the calling thread's generators, recycled when a thread exits
+uint64_t thread_stream_id();
+}  // namespace detail
+
+/// xoshiro256++ over 8 interleaved streams a jump() apart, stepped a vector at a time.
+/// The same seed and stream give the same sequence whatever the vector width. Not thread
+/// safe: one rng per thread, e.g. rng(seed, thread_index).
+class rng {
+public:
+    using result_type             = uint64_t;
+    static constexpr size_t kLanes = 8;
+
+    /// Seeded with random_seed()
+    rng();
+    /// The streams of a seed are a long_jump() apart
+    explicit rng(uint64_t seed, uint64_t stream = 0);
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+    result_type operator()() {
+        if (pos_ == kLanes) {
+            refill();
+        }
+        return cache_[pos_++];
+    }
+
+    /// [0, 1)
+    double uniform();
+    /// [lo, hi]
+    int64_t uniform(int64_t lo, int64_t hi);
+
+    /// Moves every lane kLanes * 2^128 draws ahead, clear of all the current lanes
+    void jump();
+    /// Skips 2^192 draws of every lane, the same as the next stream
+    void long_jump();
+
+    // Bulk versions of random_bytes, random_fill and random_uniform_ints
+
+    void bytes(void* buf, size_t n);
+    void fill(double* out, size_t n);
+    void uniform_ints(int64_t* out, size_t n, int64_t lo, int64_t hi);
+
+private:
+    struct lanes;
+    friend void detail::shuffle_draws(rng& g, uint64_t* out, size_t n, uint64_t top);
+
+    void refill();
+    void jump_lanes(const uint64_t* poly, size_t times);
+
+    uint64_t state_[4][kLanes]; /* lane j is state_[0..3][j] */
+    uint64_t cache_[kLanes];
+    size_t pos_;
+};
+
+namespace detail {
+template <typename T, typename Draw>
+void shuffle(T* p, size_t n, Draw&& draw) {
+    uint64_t j[256];
+    for (size_t i = n; i > 1;) {
+        const size_t m = i - 1 < 256 ? i - 1 : 256;
+        draw(j, m, i - 1);
+        for (size_t k = 0; k < m; ++k, --i) {
+            using std::swap;
+            swap(p[i - 1], p[j[k]]);
+        }
+    }
+}
+}  // namespace detail
+
+// Sampling. The versions without an rng draw from the thread's generator.
+
+/// Fisher-Yates, the swap partners drawn in blocks a vector at a time
+template <typename T>
+void shuffle(T* p, size_t n) {
+    detail::shuffle(p, n, [](uint64_t* out, size_t m, uint64_t top) {
+        detail::shuffle_draws(out, m, top);
+    });
+}
+
+template <typename T>
+void shuffle(rng& g, T* p, size_t n) {
+    detail::shuffle(p, n, [&g](uint64_t* out, size_t m, uint64_t top) {
+        detail::shuffle_draws(g, out, m, top);
+    });
+}
+
+template <typename V, typename Dummy = std::enable_if_t<lcrypt_has_member_data_v<V>>>
+void shuffle(V& v) {
+    shuffle(v.data(), v.size());
+}
+
+template <typename V, typename Dummy = std::enable_if_t<lcrypt_has_member_data_v<V>>>
+void shuffle(rng& g, V& v) {
+    shuffle(g, v.data(), v.size());
+}
+
+/// `k` distinct indices of [0, n) in random order
+std::vector<size_t> sample_indices(size_t n, size_t k);
+std::vector<size_t> sample_indices(rng& g, size_t n, size_t k);
+
+/// Walker's alias method: i with probability w[i] / sum(w) in O(1) a draw
+class weighted_choice {
+public:
+    /// Throws std::invalid_argument on no weights, a negative or non-finite weight or a zero
+    /// sum
+    weighted_choice(const double* w, size_t n);
+    template <typename V, typename Dummy = std::enable_if_t<lcrypt_has_member_data_v<V>>>
+    explicit weighted_choice(const V& w) : weighted_choice(w.data(), w.size()) {}
+
+    size_t size() const { return prob_.size(); }
+
+    size_t operator()() const;
+    size_t operator()(rng& g) const;
+    /// `count` draws into `out`
+    void operator()(size_t* out, size_t count) const;
+    void operator()(rng& g, size_t* out, size_t count) const;
+
+private:
+    void select(size_t* out, const int64_t* col, const uint32_t* coin, size_t n) const;
+
+    std::vector<uint32_t> prob_; /* column i keeps i when a 32 bit coin is below prob_[i] */
+    std::vector<uint32_t> alias_;
+};
+
 }  // namespace lc
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <lcrypt/base.h>
+#include <stdint.h>
+
+namespace lc {
+
+// Pass the previous result as `crc` to continue over more data, 0 to start.
+
+/// CRC-32C (Castagnoli), as in iSCSI, ext4 and most storage formats
+uint32_t crc32c(const void* data, size_t len, uint32_t crc = 0);
+/// CRC-32 of zlib, gzip and PNG
+uint32_t crc32(const void* data, size_t len, uint32_t crc = 0);
+
+/// The CRC of A followed by B from crc(A), crc(B) and the length of B, to merge CRCs of
+/// pieces computed in parallel
+uint32_t crc32c_combine(uint32_t crc_a, uint32_t crc_b, uint64_t len_b);
+uint32_t crc32_combine(uint32_t crc_a, uint32_t crc_b, uint64_t len_b);
+
+template <typename V, typename Dummy = std::enable_if_t<lcrypt_has_member_data_v<V>>>
+uint32_t crc32c(const V& v, uint32_t crc = 0) {
+    auto s = to_span(v);
+    return crc32c(s.data(), s.size(), crc);
+}
+
+template <typename V, typename Dummy = std::enable_if_t<lcrypt_has_member_data_v<V>>>
+uint32_t crc32(const V& v, uint32_t crc = 0) {
+    auto s = to_span(v);
+    return crc32(s.data(), s.size(), crc);
+}
+
+}  // namespace lc
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <lcrypt/base.h>
+
+namespace lc {
+
+/// RFC 4180 style reader, use '\t' as delimiter for TSV.
+/// Records end with "\n" or "\r\n", blank lines are skipped. Delimiters and newlines inside
+/// quotes belong to the field, a field is unquoted only if it starts and ends with a quote, other fields are
+/// returned as is.
+class csv_reader {
+public:
+    /// `data` must outlive the reader.
+    explicit csv_reader(std::string_view data, char delimiter = ',', char quote = '"')
+      : data_(data), delim_(delimiter), quote_(quote) {}
+
+    /// Reads the next record into `fields`, returns false at the end of input.
+    /// Fields without doubled quotes are views into `data`, the others are unescaped into
+    /// storage owned by the reader and valid until the next call.
+    /// Throws input_error on an unterminated quoted field.
+    bool next(std::vector<std::string_view>& fields);
+
+    /// Offset of the first byte not consumed yet
+    size_t offset() const { return start_ < data_.size() ? start_ : data_.size(); }
+
+private:
+    void load_block();
+    void push_field(std::vector<std::string_view>& fields, size_t end, bool eol);
+
+    std::string_view data_;
+    char delim_;
+    char quote_;
+
+    size_t block_     = 0;  // offset of the current 64-byte block
+    size_t next_      = 0;  // offset of the next block
+    size_t start_     = 0;  // first byte of the current field
+    uint64_t seps_    = 0;  // unquoted delimiters and newlines not consumed yet
+    uint64_t eols_    = 0;  // newlines of the block
+    uint64_t quotes_  = 0;  // quotes of the block not counted yet
+    uint64_t inquote_ = 0;  // all ones if the block ended inside quotes
+    size_t nquotes_   = 0;  // quotes in the current field
+
+    std::string buf_;
+    std::vector<std::pair<size_t, size_t>> unescaped_;  // (field index, offset in buf_)
+};
+
+}  // namespace lc
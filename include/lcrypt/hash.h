@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <string_view>
+#include <lcrypt/base.h>
+#include <stdint.h>
+
+namespace lc {
+
+/// XXH3 64 bit (xxHash 0.8), the same values as XXH3_64bits_withSeed. For sharding, dedup and
+/// checksums; an attacker who picks the keys can flood a table, use siphash24 there.
+uint64_t hash64(const void* data, size_t len, uint64_t seed = 0);
+
+template <typename V, typename Dummy = std::enable_if_t<lcrypt_has_member_data_v<V>>>
+uint64_t hash64(const V& v, uint64_t seed = 0) {
+    auto s = to_span(v);
+    return hash64(s.data(), s.size(), seed);
+}
+
+/// out[i] = hash64(keys[i], seed)
+void hash64_batch(const std::string_view* keys, size_t n, uint64_t* out, uint64_t seed = 0);
+
+/// The secret 128 bit key of SipHash, one per process from lc::secure_random_bytes
+/// (aes128.h). Not from random_bytes, its output gives away the generator state.
+using siphash_key = std::array<uint8_t, 16>;
+
+/// SipHash-2-4, the keyed hash of hash tables that face untrusted keys
+uint64_t siphash24(const siphash_key& key, const void* data, size_t len);
+/// SipHash-1-3, fewer rounds for tables, as in Rust and Python
+uint64_t siphash13(const siphash_key& key, const void* data, size_t len);
+
+template <typename V>
+uint64_t siphash24(const siphash_key& key, const V& v) {
+    auto s = to_span(v);
+    return siphash24(key, s.data(), s.size());
+}
+
+template <typename V>
+uint64_t siphash13(const siphash_key& key, const V& v) {
+    auto s = to_span(v);
+    return siphash13(key, s.data(), s.size());
+}
+
+/// out[i] = siphash24(key, keys[i]), a key per SIMD lane
+void siphash24_batch(const siphash_key& key, const std::string_view* keys, size_t n,
+                     uint64_t* out);
+void siphash13_batch(const siphash_key& key, const std::string_view* keys, size_t n,
+                     uint64_t* out);
+
+}  // namespace lc
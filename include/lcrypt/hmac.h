@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string_view>
+#include <lcrypt/base.h>
+#include <lcrypt/sha256.h>
+#include <stdint.h>
+
+namespace lc {
+
+/// RFC 2104 HMAC-SHA256 under a long lived key. The key is padded and hashed into the inner
+/// and outer states once, a MAC is then the message blocks plus two finalizations.
+class hmac_sha256_key {
+public:
+    using digest_t = sha256::digest_t;
+
+    hmac_sha256_key(const void* key, size_t len);
+    template <typename V>
+    explicit hmac_sha256_key(const V& key) : hmac_sha256_key(to_span(key).data(), to_span(key).size()) {}
+    ~hmac_sha256_key();
+
+    digest_t sign(const void* msg, size_t len) const;
+    /// Constant time in the MAC, false unless `mac_len` is kDigestSize
+    bool verify(const void* msg, size_t len, const void* mac, size_t mac_len) const;
+
+    template <typename V>
+    digest_t sign(const V& msg) const {
+        auto s = to_span(msg);
+        return sign(s.data(), s.size());
+    }
+
+    template <typename V, typename M>
+    bool verify(const V& msg, const M& mac) const {
+        auto s = to_span(msg);
+        auto m = to_span(mac);
+        return verify(s.data(), s.size(), m.data(), m.size());
+    }
+
+    /// out[i] = sign(msgs[i]), the messages a SHA-256 lane each like sha256_batch
+    void sign_batch(const std::string_view* msgs, size_t n, digest_t* out) const;
+    /// ok[i] = verify(msgs[i], macs[i])
+    void verify_batch(const std::string_view* msgs, const digest_t* macs, size_t n, bool* ok) const;
+
+private:
+    uint32_t inner_[8]; /* sha256 state after key ^ ipad */
+    uint32_t outer_[8]; /* sha256 state after key ^ opad */
+};
+
+/// One shot, for keys used once
+sha256::digest_t hmac_sha256(const void* key, size_t key_len, const void* msg, size_t len);
+
+}  // namespace lc
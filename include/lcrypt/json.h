@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <lcrypt/base.h>
+
+namespace lc {
+
+/// Escapes `"`, `\` and control bytes, other bytes (including UTF-8) are copied as is.
+std::string json_escape(const char* buf, size_t len);
+/// Throws input_error on invalid escapes and unpaired \uXXXX surrogates.
+std::string json_unescape(const char* buf, size_t len);
+
+size_t json_escape_size(const char* buf, size_t len);
+
+/// `out` must hold json_escape_size(buf, len) bytes, returns the bytes written.
+size_t json_escape(const char* buf, size_t len, char* out);
+/// `out` must hold `len` bytes, returns the bytes written.
+size_t json_unescape(const char* buf, size_t len, char* out);
+
+template <typename V>
+std::string json_escape(const V& v) {
+    auto s = to_span(v);
+    return json_escape(s.data(), s.size());
+}
+
+template <typename V>
+std::string json_unescape(const V& v) {
+    auto s = to_span(v);
+    return json_unescape(s.data(), s.size());
+}
+
+template <typename V>
+size_t json_escape_size(const V& v) {
+    auto s = to_span(v);
+    return json_escape_size(s.data(), s.size());
+}
+
+}  // namespace lc
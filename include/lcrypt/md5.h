@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <string_view>
+#include <lcrypt/base.h>
+#include <stdint.h>
+
+namespace lc {
+
+/// RFC 1321 MD5. Broken for signatures, still fine for ETags and dedup keys.
+class md5 {
+public:
+    static constexpr size_t kDigestSize = 16;
+    static constexpr size_t kBlockSize  = 64;
+    using digest_t                      = std::array<uint8_t, kDigestSize>;
+
+    md5() { reset(); }
+
+    void reset();
+    md5& update(const void* data, size_t len);
+    /// Pads the message and returns its hash, the context is reset for the next one
+    digest_t digest();
+
+    template <typename V>
+    md5& update(const V& v) {
+        auto s = to_span(v);
+        return update(s.data(), s.size());
+    }
+
+    static digest_t hash(const void* data, size_t len);
+
+    template <typename V>
+    static digest_t hash(const V& v) {
+        auto s = to_span(v);
+        return hash(s.data(), s.size());
+    }
+
+private:
+    uint32_t h_[4];
+    uint8_t buf_[kBlockSize];
+    uint64_t len_;
+};
+
+/// out[i] = md5::hash(msgs[i]), a message per SIMD lane
+void md5_batch(const std::string_view* msgs, size_t n, md5::digest_t* out);
+
+}  // namespace lc
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <lcrypt/base.h>
+#include <stdint.h>
+
+namespace lc {
+
+/// SHA-1, for protocols that still require it (WebSocket handshakes, legacy signatures).
+/// Uses the SHA extensions when built for a CPU that has them.
+class sha1 {
+public:
+    static constexpr size_t kDigestSize = 20;
+    static constexpr size_t kBlockSize  = 64;
+    using digest_t                      = std::array<uint8_t, kDigestSize>;
+
+    sha1() { reset(); }
+
+    void reset();
+    sha1& update(const void* data, size_t len);
+    /// Pads the message and returns its hash, the context is reset for the next one
+    digest_t digest();
+
+    template <typename V>
+    sha1& update(const V& v) {
+        auto s = to_span(v);
+        return update(s.data(), s.size());
+    }
+
+    static digest_t hash(const void* data, size_t len);
+
+    template <typename V>
+    static digest_t hash(const V& v) {
+        auto s = to_span(v);
+        return hash(s.data(), s.size());
+    }
+
+private:
+    uint32_t h_[5];
+    uint8_t buf_[kBlockSize];
+    uint64_t len_;
+};
+
+/// out[i] = sha1::hash(msgs[i]), a message per SIMD lane like sha256_batch
+void sha1_batch(const std::string_view* msgs, size_t n, sha1::digest_t* out);
+
+/// base64(sha1(data)), e.g. Sec-WebSocket-Accept from the key and the protocol GUID
+std::string sha1_base64(const char* data, size_t len);
+
+template <typename V>
+std::string sha1_base64(const V& v) {
+    auto s = to_span(v);
+    return sha1_base64(s.data(), s.size());
+}
+
+}  // namespace lc
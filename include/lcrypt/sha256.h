@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <string_view>
+#include <lcrypt/base.h>
+#include <stdint.h>
+
+namespace lc {
+
+/// FIPS 180-4 SHA-256. Uses the SHA extensions when built for a CPU that has them.
+class sha256 {
+public:
+    static constexpr size_t kDigestSize = 32;
+    static constexpr size_t kBlockSize  = 64;
+    using digest_t                      = std::array<uint8_t, kDigestSize>;
+
+    sha256() { reset(); }
+    /// Resumes from the chaining value `h` after `len` bytes, a multiple of kBlockSize. For
+    /// the precomputed pads of HMAC.
+    sha256(const uint32_t* h, uint64_t len);
+
+    void reset();
+    sha256& update(const void* data, size_t len);
+    /// Pads the message and returns its hash, the context is reset for the next one
+    digest_t digest();
+
+    template <typename V>
+    sha256& update(const V& v) {
+        auto s = to_span(v);
+        return update(s.data(), s.size());
+    }
+
+    static digest_t hash(const void* data, size_t len);
+
+    /// The chaining value, valid when the bytes so far are a multiple of kBlockSize
+    const uint32_t* state() const { return h_; }
+
+    template <typename V>
+    static digest_t hash(const V& v) {
+        auto s = to_span(v);
+        return hash(s.data(), s.size());
+    }
+
+private:
+    uint32_t h_[8];
+    uint8_t buf_[kBlockSize];
+    uint64_t len_;
+};
+
+/// out[i] = sha256::hash(msgs[i]). Without the SHA extensions, or with 16 u32 lanes, the
+/// messages are hashed in parallel, one per SIMD lane.
+void sha256_batch(const std::string_view* msgs, size_t n, sha256::digest_t* out);
+
+}  // namespace lc
@@ -1,12 +1,21 @@
 #pragma once
 
+#include <array>
+#include <deque>
 #include <tuple>
 #include <exception>
+#include <map>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 #include <vector>
 #include <lcrypt/base.h>
+#include <limits.h>
+#include <stddef.h>
+#include <string.h>
+#if __cpp_nontype_template_args >= 201911L
+#    include <bit>
+#endif
 
 namespace lc {
 
@@ -23,8 +32,115 @@ std::string_view str_trim(std::string_view str);
 bool str_starts_with(std::string_view s, std::string_view perfix);
 bool str_ends_with(std::string_view s, std::string_view perfix);
 
+// ASCII case-insensitive variants, no allocation
+void str_toupper_inplace(char* s, size_t len);
+void str_tolower_inplace(char* s, size_t len);
+
+inline void str_toupper_inplace(std::string& s) {
+    str_toupper_inplace(s.data(), s.size());
+}
+
+inline void str_tolower_inplace(std::string& s) {
+    str_tolower_inplace(s.data(), s.size());
+}
+
+bool str_iequals(std::string_view a, std::string_view b);
+bool str_istarts_with(std::string_view s, std::string_view prefix);
+bool str_iends_with(std::string_view s, std::string_view suffix);
+/// npos if not found
+size_t str_ifind(std::string_view s, std::string_view needle, size_t pos = 0);
+/// str_ihash(a) == str_ihash(b) if str_iequals(a, b)
+size_t str_ihash(std::string_view s);
+
+// for std::unordered_map<std::string, V, str_ihasher, str_iequal_to>
+struct str_ihasher {
+    size_t operator()(std::string_view s) const { return str_ihash(s); }
+};
+
+struct str_iequal_to {
+    bool operator()(std::string_view a, std::string_view b) const { return str_iequals(a, b); }
+};
+
+// utf8
+
+/// Returns npos if `s` is valid UTF-8, otherwise the offset of the first invalid sequence.
+size_t utf8_validate(std::string_view s);
+
+inline bool utf8_is_valid(std::string_view s) {
+    return utf8_validate(s) == std::string_view::npos;
+}
+
+/// throws input_error on invalid input
+std::u16string utf8_to_utf16(std::string_view s);
+/// throws input_error on unpaired surrogates
+std::string utf16_to_utf8(std::u16string_view s);
+
+// varints, protobuf base 128 with zigzag encoding for signed values
+
+constexpr uint64_t zigzag_encode(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+constexpr int64_t zigzag_decode(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+/// 1 to 10 bytes
+constexpr size_t varint_size(uint64_t v) {
+    size_t n = 1;
+    for (; v >= 0x80; v >>= 7) {
+        ++n;
+    }
+    return n;
+}
+
+/// Number of varints in `data`, the bytes without the continuation bit
+size_t varint_count(std::string_view data);
+
+/// Decodes a packed repeated field into `out`, which holds varint_count(data) values.
+/// Returns the number of values, throws input_error on a truncated or too long varint.
+size_t varint_decode(std::string_view data, uint64_t* out);
+std::vector<uint64_t> varint_decode(std::string_view data);
+
+/// `out` holds 10 * n bytes, returns the bytes written
+size_t varint_encode(const uint64_t* v, size_t n, char* out);
+std::string varint_encode(const uint64_t* v, size_t n);
+
+void zigzag_encode(const int64_t* v, size_t n, uint64_t* out);
+void zigzag_decode(const uint64_t* v, size_t n, int64_t* out);
+
+class pack_format;
+
 namespace detail {
 
+inline size_t varint_write(char* out, uint64_t v) {
+    size_t n = 0;
+    for (; v >= 0x80; v >>= 7) {
+        out[n++] = (char)(v | 0x80);
+    }
+    out[n++] = (char)v;
+    return n;
+}
+
+/// Returns the bytes read, 0 if `len` ends before the varint
+inline size_t varint_read(const char* p, size_t len, uint64_t& v) {
+    v = 0;
+    for (size_t i = 0; i < len && i < 10; ++i) {
+        const uint64_t b = (uint8_t)p[i];
+        if (i == 9 && b > 1) {
+            break;
+        }
+        v |= (b & 0x7f) << (7 * i);
+        if (b < 0x80) {
+            return i + 1;
+        }
+    }
+    if (len >= 10) {
+        throw std::runtime_error("varint does not fit into Integer");
+    }
+    return 0;
+}
+
 enum KOption {
     Kint = 0,   /* signed integers */
     Kuint,      /* unsigned integers */
@@ -33,13 +149,41 @@ enum KOption {
     Kchar,      /* fixed-length strings */
     Kstring,    /* strings with prefixed length */
     Kzstr,      /* zero-terminated strings */
+    Kvarint,    /* unsigned base 128 varints */
+    Kzigzag,    /* signed varints, zigzag encoded */
+    Kvstring,   /* strings with a varint length */
     Kpadding,   /* padding */
     Kpaddalign, /* padding for alignment */
     Knop,       /* no-op (configuration or spaces) */
     Kend,
 };
 
+/// Offset of the first '\\0' in s[0, len), or `len`
+size_t find_nul(const char* s, size_t len);
+
+/// An option resolved by pack_format, `align` applies to the offset it is packed at.
+struct PackOp {
+    KOption op;
+    uint32_t size;
+    uint32_t align;
+    int islittle;
+};
+
+/// Bytes of the host value a numeric op is read into by PackFmtParser::readcolumn:
+/// the size of 1, 2, 4 and 8 byte integers and floats, 8 (int64_t) for the other integers
+constexpr size_t pack_lanesize(const PackOp& op) {
+    return (op.size == 1 || op.size == 2 || op.size == 4 || op.size == 8) ? op.size : 8;
+}
+
+/// The packed size does not depend on the value
+constexpr bool pack_isfixed(const PackOp& op) {
+    return op.op != Kstring && op.op != Kzstr && op.op != Kvarint && op.op != Kzigzag
+           && op.op != Kvstring;
+}
+
 class PackFmtParser {
+    friend class lc::pack_format;
+
     const std::string_view fmt_;
     const int count_;
     int offset_;
@@ -48,16 +192,18 @@ class PackFmtParser {
     size_t totalsize_;
 
     inline static constexpr char PACKPADBYTE = 0x00;
-    static std::string to_string(KOption op);
-    static std::exception_ptr make_error(std::string_view tname, KOption op);
 
 public:
     using buffer_t = std::vector<char>;
 
+    static std::string to_string(KOption op);
+    static std::exception_ptr make_error(std::string_view tname, KOption op);
+
     struct option_t {
         KOption op;
         size_t size;
         size_t ntoalign;
+        size_t align; /* 1 or a power of 2, `ntoalign` for any offset */
         int islittle;
     };
 
@@ -76,6 +222,8 @@ public:
         switch (op.op) {
         case Kint: packint(b, (uint64_t)v, op, (v < 0)); break;
         case Kuint: packint(b, (uint64_t)v, op, 0); break;
+        case Kvarint: add_size(packvarint(b, (uint64_t)v)); break;
+        case Kzigzag: add_size(packvarint(b, zigzag_encode((int64_t)v))); break;
         case Kfloat: {
             float f = std::forward<T>(v);
             copywithendian(b, (char*)&f, sizeof(f), op.islittle);
@@ -101,17 +249,20 @@ public:
             v        = static_cast<U>(res);
             break;
         }
-        case Kfloat: {
-            buffer_t b;
-            copywithendian(b, s.data(), op.size, op.islittle);
-            v = static_cast<U>(*(float*)b.data());
-            break;
-        }
-        case Kdouble: {
-            buffer_t b;
-            copywithendian(b, s.data(), op.size, op.islittle);
-            v = static_cast<U>(*(double*)b.data());
+        case Kfloat:
+        case Kdouble:
+            if (s.size() >= op.size) { /* short data is reported by the caller */
+                v = static_cast<U>(
+                    readfloat(s.data(), {op.op, (uint32_t)op.size, (uint32_t)op.align, op.islittle}));
+            }
             break;
+        case Kvarint:
+        case Kzigzag: {
+            uint64_t x;
+            const size_t n = detail::varint_read(s.data(), s.size(), x);
+            v = op.op == Kzigzag ? static_cast<U>(zigzag_decode(x)) : static_cast<U>(x);
+            consumed       = n ? (int)n : (int)s.size() + 1; /* truncated */
+            return;
         }
         default: std::rethrow_exception(make_error(typeid(U).name(), op.op)); break;
         }
@@ -119,23 +270,197 @@ public:
         consumed = op.size;
     }
 
+    /// `v` points into `s`
+    void unpackone(std::string_view& v, int& consumed, std::string_view s, const option_t& op);
     void unpackone(std::string& v, int& consumed, std::string_view s, const option_t& op);
     void unpackone(buffer_t& v, int& consumed, std::string_view s, const option_t& op) {
-        std::string ss;
-        unpackone(ss, consumed, s, op);
-        v = buffer_t(ss.begin(), ss.end());
+        std::string_view sv;
+        unpackone(sv, consumed, s, op);
+        v.assign(sv.begin(), sv.end());
     }
 
+    int islittle() const { return islittle_; }
+    int maxalign() const { return maxalign_; }
+
+    // raw writers, `out` has room for the value
+    static void writeint(char* out, const PackOp& op, uint64_t n, int neg);
+    static void writefloat(char* out, const PackOp& op, double v);
+    /// Kchar/Kstring/Kzstr, returns the bytes written
+    static size_t writestr(char* out, const PackOp& op, std::string_view v);
+    static double readfloat(const char* p, const PackOp& op);
+
+    // numeric columns, field `i` of `n` records is at data + i * stride and the host values
+    // are pack_lanesize(op) bytes each, byte order is converted a vector at a time
+    static void readcolumn(const char* src, size_t stride, size_t n, const PackOp& op, void* out);
+    static void writecolumn(char* dst, size_t stride, size_t n, const PackOp& op, const void* in);
+
 private:
     int getnum_from_current(int df);
 
     // packint()
     static void packint(buffer_t& b, uint64_t n, const option_t& op, int neg);
+    static size_t packvarint(buffer_t& b, uint64_t n);
     static int64_t unpackint(std::string_view s, int islittle, int issigend);
     // int64_t unpackint(const option_t& op, int issigend);
     static void copywithendian(buffer_t& dest, const char* src, int size, int islittle);
 };
 
+/// Ops of a format string, parsed as they are read
+class PackOpParser {
+    PackFmtParser pfp_;
+
+public:
+    explicit PackOpParser(std::string_view fmt) : pfp_(fmt) {}
+
+    /// false at the end of the format, Knop is skipped
+    bool next(PackOp& op);
+};
+
+/// Ops of a pack_format
+struct PackOpRange {
+    const PackOp* cur;
+    const PackOp* end;
+
+    bool next(PackOp& op) {
+        if (cur == end) {
+            return false;
+        }
+        op = *cur++;
+        return true;
+    }
+};
+
+constexpr size_t pack_ntoalign(size_t offset, size_t align) {
+    return (align - (offset & (align - 1))) & (align - 1);
+}
+
+template <typename T>
+inline size_t pack_argsize(const PackOp& op, const T& v) {
+    if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+        const size_t n = std::string_view(v).size();
+        switch (op.op) {
+        case Kstring: return op.size + n;
+        case Kzstr: return n + 1;
+        case Kvstring: return varint_size(n) + n;
+        default: return op.size;
+        }
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        switch (op.op) {
+        case Kvarint: return varint_size((uint64_t)v);
+        case Kzigzag: return varint_size(zigzag_encode((int64_t)v));
+        default: return op.size;
+        }
+    } else {
+        return op.size;
+    }
+}
+
+template <typename T, typename U = std::decay_t<T>>
+inline void pack_writeone(char* out, size_t& pos, const PackOp& op, const T& v) {
+    if constexpr (std::is_integral_v<U> || std::is_floating_point_v<U>) {
+        switch (op.op) {
+        case Kint: PackFmtParser::writeint(out + pos, op, (uint64_t)v, (v < 0)); break;
+        case Kuint: PackFmtParser::writeint(out + pos, op, (uint64_t)v, 0); break;
+        case Kfloat:
+        case Kdouble: PackFmtParser::writefloat(out + pos, op, (double)v); break;
+        case Kvarint: pos += varint_write(out + pos, (uint64_t)v); return;
+        case Kzigzag: pos += varint_write(out + pos, zigzag_encode((int64_t)v)); return;
+        default: std::rethrow_exception(PackFmtParser::make_error(typeid(U).name(), op.op)); break;
+        }
+        pos += op.size;
+    } else {
+        pos += PackFmtParser::writestr(out + pos, op, std::string_view(v));
+    }
+}
+
+/// Exact packed size, first pass of str_pack_into
+template <typename Ops, typename... Args>
+size_t pack_size(Ops ops, const Args&... args) {
+    size_t pos   = 0;
+    bool end     = false;
+    PackOp op    = {};
+    const auto f = [&](const auto& a) {
+        while (!end) {
+            if (!ops.next(op)) {
+                end = true;  // extra arguments are ignored like str_pack
+                break;
+            }
+            pos += pack_ntoalign(pos, op.align);
+            if (op.op == Kpadding || op.op == Kpaddalign) {
+                pos += op.size;
+                continue;
+            }
+            pos += pack_argsize(op, a);
+            break;
+        }
+    };
+    ((f(args)), ...);
+    while (!end && ops.next(op)) {
+        if (op.op != Kpadding && op.op != Kpaddalign) {
+            throw std::runtime_error("Need params!!!");
+        }
+        pos += pack_ntoalign(pos, op.align) + op.size;
+    }
+    return pos;
+}
+
+/// Second pass of str_pack_into, `out` holds pack_size(ops, args...) bytes
+template <typename Ops, typename... Args>
+size_t pack_write(Ops ops, char* out, const Args&... args) {
+    size_t pos    = 0;
+    bool end      = false;
+    PackOp op     = {};
+    const auto pad = [&] {
+        const size_t n = pack_ntoalign(pos, op.align) + (op.op == Kpadding);
+        memset(out + pos, 0, n);
+        pos += n;
+    };
+    const auto f = [&](const auto& a) {
+        while (!end) {
+            if (!ops.next(op)) {
+                end = true;
+                break;
+            }
+            pad();
+            if (op.op == Kpadding || op.op == Kpaddalign) {
+                continue;
+            }
+            pack_writeone(out, pos, op, a);
+            break;
+        }
+    };
+    ((f(args)), ...);
+    while (!end && ops.next(op)) {
+        if (op.op != Kpadding && op.op != Kpaddalign) {
+            throw std::runtime_error("Need params!!!");
+        }
+        pad();
+    }
+    return pos;
+}
+
+template <typename Buffer>
+inline char* pack_grow(Buffer& b, size_t n) {
+    static_assert(sizeof(typename Buffer::value_type) == 1, "Expect a byte buffer");
+    const size_t old = b.size();
+    b.resize(old + n);
+    return (char*)b.data() + old;
+}
+
+/// Grows `b` by `n` bytes for write(out). If write throws on a bad argument, `b` is cut back
+/// to its old size instead of keeping `n` zero bytes.
+template <typename Buffer, typename Write>
+inline size_t pack_grow_write(Buffer& b, size_t n, Write&& write) {
+    const size_t old = b.size();
+    char* out        = pack_grow(b, n);
+    try {
+        return write(out);
+    } catch (...) {
+        b.resize(old);
+        throw;
+    }
+}
+
 }  // namespace detail
 
 template <typename... Args>
@@ -239,4 +564,1283 @@ str_unpack(std::string_view fmt, const std::vector<char>& data) {
     return str_unpack<Args...>(fmt, std::string_view(data.data(), data.size()));
 }
 
+/// Size of str_pack(fmt, args...)
+template <typename... Args>
+size_t str_pack_size(std::string_view fmt, const Args&... args) {
+    return detail::pack_size(detail::PackOpParser(fmt), args...);
+}
+
+/// Packs into `out` without allocating, returns the bytes written.
+/// Throws if `len` is less than str_pack_size(fmt, args...).
+template <typename... Args>
+size_t str_pack_into(char* out, size_t len, std::string_view fmt, const Args&... args) {
+    const size_t n = str_pack_size(fmt, args...);
+    if (n > len) {
+        throw std::runtime_error("Buffer too small");
+    }
+    return detail::pack_write(detail::PackOpParser(fmt), out, args...);
+}
+
+/// Appends to a std::string or std::vector<char> with one resize, returns the bytes written.
+template <typename Buffer, typename... Args>
+size_t str_pack_append(Buffer& b, std::string_view fmt, const Args&... args) {
+    const size_t n = str_pack_size(fmt, args...);
+    return detail::pack_grow_write(b, n, [&](char* out) {
+        return detail::pack_write(detail::PackOpParser(fmt), out, args...);
+    });
+}
+
+class pack_reader;
+
+/// A field of unpack_values(): an integer, a float ('f' 'd' 'n') or a string pointing into
+/// the unpacked data. Unsigned integers keep their bits, like Lua's string.unpack.
+struct pack_value {
+    enum type_t : uint8_t { integer, number, string };
+
+    union {
+        int64_t i;
+        double d;
+        const char* s;
+    };
+    size_t len  = 0; /* string only */
+    type_t type = integer;
+
+    pack_value() : i(0) {}
+
+    int64_t as_integer() const { return i; }
+    double as_number() const { return d; }
+    std::string_view as_string() const { return {s, len}; }
+};
+
+namespace detail {
+template <typename T>
+struct PackAggregate;
+}  // namespace detail
+
+/// A format parsed once by PackFmtParser, for formats used over and over.
+/// pack()/unpack() give the same results as str_pack/str_unpack with the same format.
+class pack_format {
+    friend class pack_reader;
+    friend size_t unpack_values(const pack_format&, std::string_view, std::vector<pack_value>&);
+    template <typename T>
+    friend struct detail::PackAggregate;
+
+public:
+    using op_t = detail::PackOp;
+
+    explicit pack_format(std::string_view fmt);
+
+    /// no Knop/Kend
+    const std::vector<op_t>& ops() const { return ops_; }
+
+    /// Size of pack(args...)
+    template <typename... Args>
+    size_t size(const Args&... args) const {
+        return detail::pack_size(range(), args...);
+    }
+
+    template <typename... Args>
+    std::vector<char> pack(const Args&... args) const {
+        std::vector<char> b;
+        pack_append(b, args...);
+        return b;
+    }
+
+    /// Throws if `len` is less than size(args...), returns the bytes written.
+    template <typename... Args>
+    size_t pack_into(char* out, size_t len, const Args&... args) const {
+        if (size(args...) > len) {
+            throw std::runtime_error("Buffer too small");
+        }
+        return detail::pack_write(range(), out, args...);
+    }
+
+    /// Appends to a std::string or std::vector<char> with one resize, returns the bytes written.
+    template <typename Buffer, typename... Args>
+    size_t pack_append(Buffer& b, const Args&... args) const {
+        const size_t n = size(args...);
+        return detail::pack_grow_write(
+            b, n, [&](char* out) { return detail::pack_write(range(), out, args...); });
+    }
+
+    template <typename... Args>
+    std::tuple<std::decay_t<Args>..., int> unpack(std::string_view data) const {
+        using R = std::tuple<std::decay_t<Args>...>;
+        static constexpr op_t end{detail::Kend, 0, 1, 1};
+        R res;
+        size_t offset = 0;
+        size_t i      = 0;
+        const auto f  = [&](auto& x) {
+            i = unpackpad(data, offset, i);
+            unpackone(x, offset, data, i < ops_.size() ? ops_[i++] : end);
+        };
+        std::apply([&](auto&... xs) { ((f(xs)), ...); }, res);
+        if (unpackpad(data, offset, i) != ops_.size()) {
+            throw std::runtime_error("Need params!!!");
+        }
+        return std::tuple_cat(std::move(res), std::make_tuple((int)offset));
+    }
+
+    template <typename... Args>
+    std::tuple<std::decay_t<Args>..., int> unpack(const std::vector<char>& data) const {
+        return unpack<Args...>(std::string_view(data.data(), data.size()));
+    }
+
+    // Arrays of records packed back to back, each record at a multiple of record_size().
+    // Numeric fields are converted a column at a time, 'c' fields go to string types.
+
+    /// Throws if the format has 's' or 'z' fields
+    size_t record_size() const;
+
+    /// Struct of arrays, one column per value field: unpack_array(data, n, ids, prices).
+    /// Returns the bytes read.
+    template <typename... Ts>
+    size_t unpack_array(std::string_view data, size_t n, Ts*... columns) const {
+        const size_t stride = checkarray(sizeof...(Ts));
+        check(0, n * stride, data.size());
+        size_t i = 0;
+        ((unpackcolumn(data, stride, n, fields_[i++], columns, sizeof(Ts))), ...);
+        return n * stride;
+    }
+
+    /// Array of structs, one member per value field: unpack_array(data, ticks, n, &tick::id, ...)
+    template <typename S, typename... Ms>
+    size_t unpack_array(std::string_view data, S* out, size_t n, Ms S::*... members) const {
+        const size_t stride = checkarray(sizeof...(Ms));
+        check(0, n * stride, data.size());
+        size_t i = 0;
+        if (n != 0) {
+            ((unpackcolumn(data, stride, n, fields_[i++], &(out->*members), sizeof(S))), ...);
+        }
+        return n * stride;
+    }
+
+    template <typename... Ts>
+    std::vector<char> pack_array(size_t n, const Ts*... columns) const {
+        const size_t stride = checkarray(sizeof...(Ts));
+        std::vector<char> b(n * stride);
+        size_t i = 0;
+        ((packcolumn(b.data(), stride, n, fields_[i++], columns, sizeof(Ts))), ...);
+        return b;
+    }
+
+    template <typename S, typename... Ms>
+    std::vector<char> pack_array(const S* in, size_t n, Ms S::*... members) const {
+        const size_t stride = checkarray(sizeof...(Ms));
+        std::vector<char> b(n * stride);
+        size_t i = 0;
+        if (n != 0) {
+            ((packcolumn(b.data(), stride, n, fields_[i++], &(in->*members), sizeof(S))), ...);
+        }
+        return b;
+    }
+
+private:
+    using buffer_t = detail::PackFmtParser::buffer_t;
+
+    /// A value op and its offset in a record
+    struct field_t {
+        op_t op;
+        size_t offset;
+    };
+
+    /// records converted per readcolumn()/writecolumn() call when the host type differs
+    inline static constexpr size_t kArrayBlock = 256;
+
+    /// record_size(), checks the number of columns
+    size_t checkarray(size_t ncolumns) const;
+
+    static bool isnumeric(const op_t& op) {
+        return op.op == detail::Kint || op.op == detail::Kuint || op.op == detail::Kfloat
+               || op.op == detail::Kdouble;
+    }
+
+    /// T is the host type of the op, columns of T are read and written in place
+    template <typename T>
+    static bool lanematch(const op_t& op) {
+        if constexpr (std::is_same_v<T, float>) {
+            return op.op == detail::Kfloat;
+        } else if constexpr (std::is_same_v<T, double>) {
+            return op.op == detail::Kdouble;
+        } else if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+            return (op.op == detail::Kint || op.op == detail::Kuint)
+                   && sizeof(T) == detail::pack_lanesize(op);
+        } else {
+            return false;
+        }
+    }
+
+    /// Calls f with a null pointer to the host type of a numeric op
+    template <typename F>
+    static void withlane(const op_t& op, F&& f) {
+        const bool issigned = op.op == detail::Kint;
+        switch (op.op == detail::Kfloat ? 0 : detail::pack_lanesize(op)) {
+        case 0: f((float*)nullptr); break;
+        case 1: issigned ? f((int8_t*)nullptr) : f((uint8_t*)nullptr); break;
+        case 2: issigned ? f((int16_t*)nullptr) : f((uint16_t*)nullptr); break;
+        case 4: issigned ? f((int32_t*)nullptr) : f((uint32_t*)nullptr); break;
+        default:
+            if (op.op == detail::Kdouble) {
+                f((double*)nullptr);
+            } else {
+                issigned ? f((int64_t*)nullptr) : f((uint64_t*)nullptr);
+            }
+            break;
+        }
+    }
+
+    template <typename T>
+    static void unpackcolumn(std::string_view s, size_t stride, size_t n, const field_t& f, T* dst,
+                             size_t dst_stride) {
+        char* d = (char*)dst;
+        if constexpr (std::is_arithmetic_v<T>) {
+            if (lanematch<T>(f.op) && dst_stride == sizeof(T)) {
+                detail::PackFmtParser::readcolumn(s.data() + f.offset, stride, n, f.op, dst);
+                return;
+            }
+            if (isnumeric(f.op)) {
+                alignas(8) char tmp[kArrayBlock * 8];
+                withlane(f.op, [&](auto* lane) {
+                    using L = std::remove_pointer_t<decltype(lane)>;
+                    for (size_t b = 0; b < n; b += kArrayBlock) {
+                        const size_t m = n - b < kArrayBlock ? n - b : kArrayBlock;
+                        detail::PackFmtParser::readcolumn(s.data() + f.offset + b * stride, stride, m,
+                                                          f.op, tmp);
+                        for (size_t i = 0; i < m; ++i) {
+                            L x;
+                            memcpy(&x, tmp + i * sizeof(L), sizeof(L));
+                            *(T*)(d + (b + i) * dst_stride) = static_cast<T>(x);
+                        }
+                    }
+                });
+                return;
+            }
+        }
+        for (size_t i = 0; i < n; ++i) {
+            size_t offset = f.offset;
+            unpackone(*(T*)(d + i * dst_stride), offset, s.substr(i * stride, stride), f.op);
+        }
+    }
+
+    template <typename T>
+    static void packcolumn(char* out, size_t stride, size_t n, const field_t& f, const T* src,
+                           size_t src_stride) {
+        const char* p = (const char*)src;
+        if constexpr (std::is_arithmetic_v<T>) {
+            if (lanematch<T>(f.op) && src_stride == sizeof(T)) {
+                detail::PackFmtParser::writecolumn(out + f.offset, stride, n, f.op, src);
+                return;
+            }
+            if (!isnumeric(f.op)) {
+                std::rethrow_exception(detail::PackFmtParser::make_error(typeid(T).name(), f.op.op));
+            }
+            alignas(8) char tmp[kArrayBlock * 8];
+            withlane(f.op, [&](auto* lane) {
+                using L = std::remove_pointer_t<decltype(lane)>;
+                for (size_t b = 0; b < n; b += kArrayBlock) {
+                    const size_t m = n - b < kArrayBlock ? n - b : kArrayBlock;
+                    for (size_t i = 0; i < m; ++i) {
+                        const L x = static_cast<L>(*(const T*)(p + (b + i) * src_stride));
+                        memcpy(tmp + i * sizeof(L), &x, sizeof(L));
+                    }
+                    detail::PackFmtParser::writecolumn(out + f.offset + b * stride, stride, m, f.op,
+                                                       tmp);
+                }
+            });
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                detail::PackFmtParser::writestr(out + i * stride + f.offset, f.op,
+                                                std::string_view(*(const T*)(p + i * src_stride)));
+            }
+        }
+    }
+
+    detail::PackOpRange range() const { return {ops_.data(), ops_.data() + ops_.size()}; }
+
+    /// Skips the padding ops from `i` and the alignment of the next value, returns its index.
+    size_t unpackpad(std::string_view s, size_t& offset, size_t i) const;
+
+    static void check(size_t offset, size_t need, size_t len);
+
+    /// `v` points into `s`
+    static void unpackone(std::string_view& v, size_t& offset, std::string_view s, const op_t& op);
+    static void unpackone(std::string& v, size_t& offset, std::string_view s, const op_t& op);
+    static void unpackone(buffer_t& v, size_t& offset, std::string_view s, const op_t& op);
+    template <typename T, typename U = std::decay_t<T>>
+    static std::enable_if_t<std::is_integral_v<U> || std::is_floating_point_v<U>, void>  //
+    unpackone(T& v, size_t& offset, std::string_view s, const op_t& op) {
+        switch (op.op) {
+        case detail::Kint:
+        case detail::Kuint: {
+            check(offset, op.size, s.size());
+            auto res = detail::PackFmtParser::unpackint(s.substr(offset, op.size), op.islittle,
+                                                        (op.op == detail::Kint));
+            v        = static_cast<U>(res);
+            break;
+        }
+        case detail::Kfloat:
+        case detail::Kdouble:
+            check(offset, op.size, s.size());
+            v = static_cast<U>(detail::PackFmtParser::readfloat(s.data() + offset, op));
+            break;
+        case detail::Kvarint:
+        case detail::Kzigzag: {
+            uint64_t x;
+            const size_t n = detail::varint_read(s.data() + offset, s.size() - offset, x);
+            check(offset, n ? n : s.size() - offset + 1, s.size());
+            v = op.op == detail::Kzigzag ? static_cast<U>(zigzag_decode(x)) : static_cast<U>(x);
+            offset += n;
+            return;
+        }
+        default:
+            std::rethrow_exception(detail::PackFmtParser::make_error(typeid(U).name(), op.op));
+            break;
+        }
+        offset += op.size;
+    }
+
+    std::vector<op_t> ops_;
+    std::vector<field_t> fields_;
+    size_t recsize_; /* ~0 unless every op is pack_isfixed */
+};
+
+/// Unpacks without knowing the types at compile time, for bindings to scripting languages.
+/// `out` is overwritten with one value per field, its capacity is reused.
+/// Returns the bytes read, throws like pack_format::unpack.
+size_t unpack_values(const pack_format& fmt, std::string_view data, std::vector<pack_value>& out);
+
+/// Unpacks the messages of a pack_format from buffers received in pieces, fields straddling
+/// two buffers are read without joining them. `fmt` must outlive the reader.
+class pack_reader {
+public:
+    explicit pack_reader(const pack_format& fmt) : fmt_(fmt) {}
+
+    /// The bytes must stay valid until consumed() passes them
+    void feed(std::string_view segment);
+    void feed(const std::string_view* segments, size_t n);
+
+    /// Bytes fed and not consumed
+    size_t available() const { return fed_ - cur_.off; }
+    /// Bytes of the messages unpacked so far
+    size_t consumed() const { return consumed_; }
+    /// At least this many bytes are needed to finish the last incomplete message
+    size_t missing() const { return missing_; }
+
+    /// Returns false if the fed bytes end inside the message: nothing is consumed and unpack()
+    /// can be called again after feed(). std::string_view results point into a segment, or into
+    /// the reader when they straddle segments, until the next unpack().
+    template <typename... Args>
+    bool unpack(Args&... out) {
+        const cursor_t start = cur_;
+        size_t offset        = 0;
+        size_t i             = 0;
+        bool ok              = true;
+        scratch_.clear();
+        const auto f = [&](auto& x) {
+            ok = ok && unpackpad(i, offset);
+            if (ok && i == fmt_.ops_.size()) {
+                std::rethrow_exception(
+                    detail::PackFmtParser::make_error(typeid(x).name(), detail::Kend));
+            }
+            ok = ok && unpackone(x, fmt_.ops_[i++], offset);
+        };
+        ((f(out)), ...);
+        ok = ok && unpackpad(i, offset);
+        if (!ok) {
+            cur_ = start;
+            return false;
+        }
+        if (i != fmt_.ops_.size()) {
+            throw std::runtime_error("Need params!!!");
+        }
+        consumed_ += offset;
+        missing_ = 0;
+        segs_.erase(segs_.begin(), segs_.begin() + cur_.seg);
+        cur_.seg = 0;
+        return true;
+    }
+
+private:
+    using op_t = pack_format::op_t;
+
+    struct cursor_t {
+        size_t seg;
+        size_t pos;
+        size_t off; /* bytes before the cursor since the first feed() */
+    };
+
+    void advance(size_t n);
+    /// Copies `n` bytes to `out` if not null
+    bool read(char* out, size_t n);
+    /// `v` points into a segment or into scratch_
+    bool view(size_t n, std::string_view& v);
+    /// Bytes before the next '\0', without consuming them
+    bool zlen(size_t& n);
+    /// Copies a varint, up to 10 bytes
+    bool varint(char* out, size_t& n);
+    /// Skips the padding ops from `i` and the alignment of the next value
+    bool unpackpad(size_t& i, size_t& offset);
+
+    template <typename T>
+    bool unpackone(T& v, const op_t& op, size_t& offset) {
+        using U = std::decay_t<T>;
+        char tmp[16]; /* integers have 1 to 16 bytes, varints up to 10 */
+        size_t n = op.size;
+        size_t o = 0;
+        switch (op.op) {
+        case detail::Kint:
+        case detail::Kuint:
+        case detail::Kfloat:
+        case detail::Kdouble:
+            if (!read(tmp, n)) {
+                return false;
+            }
+            pack_format::unpackone(v, o, std::string_view(tmp, n), op);
+            offset += n;
+            return true;
+        case detail::Kvarint:
+        case detail::Kzigzag:
+            if (!varint(tmp, n)) {
+                return false;
+            }
+            pack_format::unpackone(v, o, std::string_view(tmp, n), op);
+            offset += n;
+            return true;
+        default: break;
+        }
+
+        if constexpr (std::is_arithmetic_v<U>) {
+            std::rethrow_exception(detail::PackFmtParser::make_error(typeid(U).name(), op.op));
+        } else {
+            // the length, then the bytes
+            size_t len = op.size;
+            op_t lenop = op;
+            switch (op.op) {
+            case detail::Kchar: n = 0; break;
+            case detail::Kstring:
+                lenop.op = detail::Kuint;
+                if (!read(tmp, n)) {
+                    return false;
+                }
+                break;
+            case detail::Kvstring:
+                lenop.op = detail::Kvarint;
+                if (!varint(tmp, n)) {
+                    return false;
+                }
+                break;
+            case detail::Kzstr:
+                n = 0;
+                if (!zlen(len)) {
+                    return false;
+                }
+                break;
+            default:
+                std::rethrow_exception(detail::PackFmtParser::make_error("string", op.op));
+                break;
+            }
+            if (lenop.op != op.op) {
+                pack_format::unpackone(len, o, std::string_view(tmp, n), lenop);
+            }
+            if (const size_t avail = available(); len > avail) {
+                missing_ = len - avail + (op.op == detail::Kzstr);
+                return false;
+            }
+            bool ok;
+            if constexpr (std::is_same_v<U, std::string_view>) {
+                ok = view(len, v);
+            } else {
+                v.resize(len);
+                ok = read((char*)v.data(), len);
+            }
+            if (!ok || (op.op == detail::Kzstr && !read(nullptr, 1))) {
+                return false;
+            }
+            offset += n + len + (op.op == detail::Kzstr);
+            return true;
+        }
+    }
+
+    const pack_format& fmt_;
+    std::vector<std::string_view> segs_;
+    cursor_t cur_    = {0, 0, 0};
+    size_t fed_      = 0; /* bytes fed so far */
+    size_t consumed_ = 0;
+    size_t missing_  = 0;
+    std::deque<std::string> scratch_; /* stable addresses for the straddling views */
+};
+
+// Aggregates, the format is derived from the member types
+
+namespace detail {
+
+/// Converts to any member type in unevaluated aggregate initialization
+struct AnyField {
+    template <typename T>
+    operator T() const;
+};
+
+template <typename T, size_t... I>
+constexpr auto aggregate_init(std::index_sequence<I...>) -> decltype(T{(void(I), AnyField{})...}, true) {
+    return true;
+}
+
+template <typename T>
+constexpr bool aggregate_init(...) {
+    return false;
+}
+
+/// Number of members, up to 16
+template <typename T, size_t N = 16>
+constexpr size_t aggregate_size() {
+    if constexpr (N == 0 || aggregate_init<T>(std::make_index_sequence<N>{})) {
+        return N;
+    } else {
+        return aggregate_size<T, N - 1>();
+    }
+}
+
+/// std::tie of the members
+template <typename T>
+auto aggregate_tie(T& v) {
+    constexpr size_t n = aggregate_size<std::remove_cv_t<T>>();
+    // clang-format off
+    if constexpr (n == 1) { auto& [a] = v; return std::tie(a); }
+    else if constexpr (n == 2) { auto& [a, b] = v; return std::tie(a, b); }
+    else if constexpr (n == 3) { auto& [a, b, c] = v; return std::tie(a, b, c); }
+    else if constexpr (n == 4) { auto& [a, b, c, d] = v; return std::tie(a, b, c, d); }
+    else if constexpr (n == 5) { auto& [a, b, c, d, e] = v; return std::tie(a, b, c, d, e); }
+    else if constexpr (n == 6) { auto& [a, b, c, d, e, f] = v; return std::tie(a, b, c, d, e, f); }
+    else if constexpr (n == 7) { auto& [a, b, c, d, e, f, g] = v; return std::tie(a, b, c, d, e, f, g); }
+    else if constexpr (n == 8) { auto& [a, b, c, d, e, f, g, h] = v; return std::tie(a, b, c, d, e, f, g, h); }
+    else if constexpr (n == 9) { auto& [a, b, c, d, e, f, g, h, i] = v; return std::tie(a, b, c, d, e, f, g, h, i); }
+    else if constexpr (n == 10) { auto& [a, b, c, d, e, f, g, h, i, j] = v; return std::tie(a, b, c, d, e, f, g, h, i, j); }
+    else if constexpr (n == 11) { auto& [a, b, c, d, e, f, g, h, i, j, k] = v; return std::tie(a, b, c, d, e, f, g, h, i, j, k); }
+    else if constexpr (n == 12) { auto& [a, b, c, d, e, f, g, h, i, j, k, l] = v; return std::tie(a, b, c, d, e, f, g, h, i, j, k, l); }
+    else if constexpr (n == 13) { auto& [a, b, c, d, e, f, g, h, i, j, k, l, m] = v; return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m); }
+    else if constexpr (n == 14) { auto& [a, b, c, d, e, f, g, h, i, j, k, l, m, o] = v; return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m, o); }
+    else if constexpr (n == 15) { auto& [a, b, c, d, e, f, g, h, i, j, k, l, m, o, p] = v; return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m, o, p); }
+    else { static_assert(n == 16, "pack: aggregates have 1 to 16 members");
+           auto& [a, b, c, d, e, f, g, h, i, j, k, l, m, o, p, q] = v; return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m, o, p, q); }
+    // clang-format on
+}
+
+template <typename T>
+struct is_char_array : std::false_type {};
+
+template <size_t N>
+struct is_char_array<std::array<char, N>> : std::true_type {};
+
+template <typename T>
+struct PackAggregate {
+    using tie_t                   = decltype(aggregate_tie(std::declval<T&>()));
+    static constexpr size_t count = std::tuple_size_v<tie_t>;
+    using ops_t                   = std::array<PackOp, count + 1>; /* and the tail padding */
+
+    template <size_t I>
+    using member_t = std::remove_cv_t<std::remove_reference_t<std::tuple_element_t<I, tie_t>>>;
+
+    /// The option of a member: a number, std::array<char, N> ('cN') or a string ('s')
+    template <typename M>
+    static constexpr PackOp memberop(int islittle) {
+        if constexpr (std::is_same_v<M, float>) {
+            return {Kfloat, sizeof(float), 1, islittle};
+        } else if constexpr (std::is_same_v<M, double>) {
+            return {Kdouble, sizeof(double), 1, islittle};
+        } else if constexpr (std::is_integral_v<M>) {
+            return {std::is_signed_v<M> ? Kint : Kuint, sizeof(M), 1, islittle};
+        } else if constexpr (is_char_array<M>::value) {
+            return {Kchar, (uint32_t)std::tuple_size_v<M>, 1, islittle};
+        } else {
+            static_assert(std::is_same_v<M, std::string> || std::is_same_v<M, std::string_view>,
+                          "pack: members are numbers, std::array<char, N> or strings");
+            return {Kstring, sizeof(size_t), 1, islittle};
+        }
+    }
+
+    /// Members are copied as they are in memory
+    template <size_t... I>
+    static constexpr bool rawmembers(std::index_sequence<I...>) {
+        return ((((std::is_arithmetic_v<member_t<I>> && !std::is_same_v<member_t<I>, bool>)
+                  || is_char_array<member_t<I>>::value))
+                && ...)
+               && (sizeof(member_t<I>) + ...) == sizeof(T);
+    }
+
+    static constexpr bool raw = std::is_trivially_copyable_v<T>
+                                && rawmembers(std::make_index_sequence<count>{});
+
+    static int hostlittle() {
+        const uint16_t one = 1;
+        char low;
+        memcpy(&low, &one, 1);
+        return low == 1;
+    }
+
+    struct layout_t {
+        ops_t ops;
+        bool native; /* the packed bytes are the bytes of T */
+    };
+
+    /// The layout of `options`, parsed once: a static for the default options, a per thread
+    /// cache for the others
+    static const layout_t& layout(std::string_view options) {
+        if (options == "=!") {
+            static const layout_t native = makelayout(options);
+            return native;
+        }
+        thread_local std::map<std::string, layout_t, std::less<>> cache;
+        auto it = cache.find(options);
+        if (it == cache.end()) {
+            it = cache.emplace(std::string(options), makelayout(options)).first;
+        }
+        return it->second;
+    }
+
+    /// `options` are byte order and alignment options, aligned like PackFmtParser::nextop
+    static layout_t makelayout(std::string_view options) {
+        PackFmtParser pfp(options);
+        PackFmtParser::option_t o;
+        for (pfp.nextop(o); o.op != Kend; pfp.nextop(o)) {
+            if (o.op != Knop) {
+                throw std::runtime_error("pack: options take no values, found "
+                                         + PackFmtParser::to_string(o.op));
+            }
+        }
+        const int islittle = pfp.islittle();
+        const size_t maxalign = pfp.maxalign();
+        const auto align      = [&](size_t size) -> uint32_t {
+            size = size > maxalign ? maxalign : size;
+            if (size > 1 && (size & (size - 1)) != 0) {
+                throw std::runtime_error("format asks for alignment not power of 2");
+            }
+            return size > 1 ? (uint32_t)size : 1;
+        };
+
+        layout_t r = {makeops(islittle, std::make_index_sequence<count>{}), raw};
+        size_t pos = 0;
+        for (auto& op : r.ops) {
+            if (op.op == Kpaddalign) {
+                op.align = align(alignof(T));
+            } else if (op.op != Kchar) {
+                op.align = align(op.size);
+            }
+            r.native = r.native && pack_ntoalign(pos, op.align) == 0;
+            pos += op.size;
+        }
+        r.native = r.native && islittle == hostlittle();
+        return r;
+    }
+
+    template <size_t... I>
+    static constexpr ops_t makeops(int islittle, std::index_sequence<I...>) {
+        return {{memberop<member_t<I>>(islittle)..., PackOp{Kpaddalign, 0, 1, islittle}}};
+    }
+
+    template <typename M>
+    static decltype(auto) packarg(const M& m) {
+        if constexpr (is_char_array<M>::value) {
+            return std::string_view(m.data(), m.size());
+        } else {
+            return (m);
+        }
+    }
+
+    template <typename Buffer>
+    static size_t pack(Buffer& b, const T& v, std::string_view options) {
+        const auto& l = layout(options);
+        if constexpr (raw) {
+            if (l.native) {
+                memcpy(pack_grow(b, sizeof(T)), &v, sizeof(T));
+                return sizeof(T);
+            }
+        }
+        const PackOpRange range = {l.ops.data(), l.ops.data() + l.ops.size()};
+        return std::apply(
+            [&](const auto&... m) {
+                const size_t n = pack_size(range, packarg(m)...);
+                return pack_grow_write(
+                    b, n, [&](char* out) { return pack_write(range, out, packarg(m)...); });
+            },
+            aggregate_tie(v));
+    }
+
+    static size_t unpack(std::string_view data, T& v, std::string_view options) {
+        const auto& l = layout(options);
+        if constexpr (raw) {
+            if (l.native) {
+                pack_format::check(0, sizeof(T), data.size());
+                memcpy(&v, data.data(), sizeof(T));
+                return sizeof(T);
+            }
+        }
+        size_t offset = 0;
+        size_t i      = 0;
+        const auto f  = [&](auto& m) {
+            using M        = std::remove_reference_t<decltype(m)>;
+            const auto& op = l.ops[i++];
+            offset += pack_ntoalign(offset, op.align);
+            pack_format::check(offset, 0, data.size());
+            if constexpr (is_char_array<M>::value) {
+                std::string_view sv;
+                pack_format::unpackone(sv, offset, data, op);
+                memcpy(m.data(), sv.data(), sv.size());
+            } else {
+                pack_format::unpackone(m, offset, data, op);
+            }
+        };
+        std::apply([&](auto&... m) { ((f(m)), ...); }, aggregate_tie(v));
+        offset += pack_ntoalign(offset, l.ops.back().align);
+        pack_format::check(offset, 0, data.size());
+        return offset;
+    }
+};
+
+}  // namespace detail
+
+/// Packs the members of an aggregate in declaration order like str_pack. Members are numbers,
+/// std::array<char, N> ('cN'), std::string or std::string_view ('s').
+/// `options` holds the byte order and alignment options of a format, the default "=!" is the
+/// native layout and a type without padding is then copied with one memcpy.
+template <typename T>
+std::vector<char> pack(const T& v, std::string_view options = "=!") {
+    std::vector<char> b;
+    detail::PackAggregate<T>::pack(b, v, options);
+    return b;
+}
+
+/// Appends to a std::string or std::vector<char>, returns the bytes written.
+template <typename Buffer, typename T>
+size_t pack_append(Buffer& b, const T& v, std::string_view options = "=!") {
+    return detail::PackAggregate<T>::pack(b, v, options);
+}
+
+/// Returns the bytes read, std::string_view members point into `data`.
+template <typename T>
+size_t unpack(std::string_view data, T& v, std::string_view options = "=!") {
+    return detail::PackAggregate<T>::unpack(data, v, options);
+}
+
+template <typename T>
+T unpack(std::string_view data, std::string_view options = "=!") {
+    T v{};
+    detail::PackAggregate<T>::unpack(data, v, options);
+    return v;
+}
+
+#if __cpp_nontype_template_args >= 201911L
+
+// Compile-time formats, str_pack<"<I4 H s2">(a, b, c)
+// The format is parsed during compilation with the rules of PackFmtParser, arguments are
+// type-checked against it and fields are written with fixed-size stores.
+
+namespace detail {
+
+template <size_t N>
+struct fixed_string {
+    char data[N] = {};
+
+    constexpr fixed_string(const char (&s)[N]) {
+        for (size_t i = 0; i < N; ++i) {
+            data[i] = s[i];
+        }
+    }
+
+    constexpr std::string_view view() const { return std::string_view(data, N - 1); }
+};
+
+inline constexpr bool ct_native_little = std::endian::native == std::endian::little;
+
+struct CtMaxAlign {
+    char c;
+    union {
+        int i;
+        double u;
+        void* s;
+    } u;
+};
+
+struct CtParseState {
+    std::string_view fmt;
+    size_t offset;
+    int islittle;
+    size_t maxalign;
+};
+
+constexpr bool ct_isdigit(char c) {
+    return '0' <= c && c <= '9';
+}
+
+constexpr size_t ct_getnum(CtParseState& st, size_t df) {
+    if (st.offset >= st.fmt.size() || !ct_isdigit(st.fmt[st.offset])) {
+        return df;
+    }
+    size_t a = 0;
+    do {
+        a = a * 10 + (st.fmt[st.offset++] - '0');
+    } while (st.offset < st.fmt.size() && ct_isdigit(st.fmt[st.offset])
+             && a <= ((size_t)INT_MAX - 9) / 10);
+    return a;
+}
+
+/// PackFmtParser::nextop
+constexpr PackOp ct_nextop(CtParseState& st) {
+    PackOp op{Knop, 0, 1, st.islittle};
+    if (st.offset >= st.fmt.size()) {
+        op.op = Kend;
+        return op;
+    }
+
+    size_t align  = 0;
+    const char ch = st.fmt[st.offset++];
+    // clang-format off
+    switch (ch) {
+    case 'b': op.size = sizeof(char); op.op = Kint; break;
+    case 'B': op.size = sizeof(char); op.op = Kuint; break;
+    case 'h': op.size = sizeof(short); op.op = Kint; break;
+    case 'H': op.size = sizeof(short); op.op = Kint; break;
+    case 'l': op.size = sizeof(long); op.op = Kuint; break;
+    case 'L': op.size = sizeof(long); op.op = Kuint; break;
+    case 'T': op.size = sizeof(size_t); op.op = Kuint; break;
+    case 'f': op.size = sizeof(float); op.op = Kfloat; break;
+    case 'd': op.size = sizeof(double); op.op = Kdouble; break;
+    case 'i': op.size = ct_getnum(st, sizeof(int)); op.op = Kint; break;
+    case 'I': op.size = ct_getnum(st, sizeof(int)); op.op = Kuint; break;
+    case 's': op.size = ct_getnum(st, sizeof(size_t)); op.op = Kstring; break;
+    case 'z': op.op = Kzstr; break;
+    case 'V': op.op = Kvarint; break;
+    case 'v': op.op = Kzigzag; break;
+    case 'S': op.op = Kvstring; break;
+    case 'x': op.size = 1; op.op = Kpadding; break;
+    case 'c': {
+        const size_t n = ct_getnum(st, (size_t)-1);
+        if (n == (size_t)-1) throw std::runtime_error("missing size for format option 'c'");
+        op.size = n;
+        op.op   = Kchar;
+        break;
+    }
+    case 'X': {
+        const PackOp op0 = ct_nextop(st);
+        if (op0.op == Kchar || op0.size == 0) {
+            throw std::runtime_error("invalid next option for option 'X'");
+        }
+        align = op0.size;
+        op.op = Kpaddalign;
+        break;
+    }
+    case ' ': break;
+    case '<': st.islittle = 1; break;
+    case '>': st.islittle = 0; break;
+    case '=': st.islittle = ct_native_little; break;
+    case '!': st.maxalign = ct_getnum(st, offsetof(CtMaxAlign, u)); break;
+    default: throw std::runtime_error("invalid format option");
+    }
+    // clang-format on
+    if ((op.op == Kint || op.op == Kuint || op.op == Kstring) && (op.size == 0 || op.size > 16)) {
+        throw std::runtime_error("integral size out of limits [1,16]");
+    }
+
+    if (op.op != Kpaddalign) {
+        align = op.size;
+    }
+    if (align > 1 && op.op != Kchar) {
+        if (align > st.maxalign) {
+            align = st.maxalign;
+        }
+        if ((align & (align - 1)) != 0) {
+            throw std::runtime_error("format asks for alignment not power of 2");
+        }
+        op.align = align > 1 ? align : 1;
+    }
+    return op;
+}
+
+template <size_t N>
+struct CtPackFormat {
+    PackOp ops[N]  = {};
+    size_t count   = 0;
+    size_t nvalues = 0;     /* ops taking an argument */
+    bool fixed     = true;  /* no s/z/V/v/S, offsets and size are constants */
+    size_t size    = 0;     /* packed size if fixed */
+};
+
+template <size_t N>
+constexpr CtPackFormat<N> ct_parse_format(std::string_view fmt) {
+    CtPackFormat<N> r;
+    CtParseState st{fmt, 0, ct_native_little, 1};
+    for (;;) {
+        const PackOp op = ct_nextop(st);
+        if (op.op == Kend) {
+            break;
+        }
+        if (op.op == Knop) {
+            continue;
+        }
+        r.ops[r.count++] = op;
+        r.nvalues += (op.op != Kpadding && op.op != Kpaddalign);
+        r.fixed = r.fixed && pack_isfixed(op);
+        r.size += pack_ntoalign(r.size, op.align) + op.size;
+    }
+    return r;
+}
+
+template <fixed_string F>
+inline constexpr auto ct_format_v = ct_parse_format<sizeof(F.data)>(F.view());
+
+/// index of the argument of ops[i]
+template <size_t N>
+constexpr size_t ct_value_index(const CtPackFormat<N>& fmt, size_t i) {
+    size_t n = 0;
+    for (size_t k = 0; k < i; ++k) {
+        n += (fmt.ops[k].op != Kpadding && fmt.ops[k].op != Kpaddalign);
+    }
+    return n;
+}
+
+constexpr uint64_t ct_bswap64(uint64_t x) {
+    x = ((x & 0x00ff00ff00ff00ffull) << 8) | ((x >> 8) & 0x00ff00ff00ff00ffull);
+    x = ((x & 0x0000ffff0000ffffull) << 16) | ((x >> 16) & 0x0000ffff0000ffffull);
+    return (x << 32) | (x >> 32);
+}
+
+/// the low `Size` bytes of `n`
+template <size_t Size, bool Little>
+inline void ct_store_uint(char* out, uint64_t n) {
+    if constexpr (ct_native_little) {
+        if constexpr (!Little) {
+            n = ct_bswap64(n << (64 - 8 * Size));
+        }
+        memcpy(out, &n, Size);
+    } else if constexpr (Little) {
+        n = ct_bswap64(n);
+        memcpy(out, &n, Size);
+    } else {
+        memcpy(out, (const char*)&n + 8 - Size, Size);
+    }
+}
+
+template <size_t Size, bool Little>
+inline uint64_t ct_load_uint(const char* p) {
+    uint64_t n = 0;
+    if constexpr (ct_native_little) {
+        memcpy(&n, p, Size);
+        if constexpr (!Little) {
+            n = ct_bswap64(n) >> (64 - 8 * Size);
+        }
+    } else if constexpr (Little) {
+        memcpy(&n, p, Size);
+        n = ct_bswap64(n);
+    } else {
+        memcpy((char*)&n + 8 - Size, p, Size);
+    }
+    return n;
+}
+
+[[noreturn]] inline void ct_overflow(size_t offset, size_t len) {
+    throw std::runtime_error(std::string("Data overflow. offset = ") + std::to_string(offset)
+                             + ", len = " + std::to_string(len));
+}
+
+/// PackFmtParser::packint
+template <PackOp Op>
+inline void ct_packint(char* out, uint64_t n, bool neg) {
+    constexpr bool L = Op.islittle != 0;
+    if constexpr (Op.size <= 8) {
+        ct_store_uint<Op.size, L>(out, n);
+    } else {
+        const char fill = neg ? (char)0xff : 0;
+        if constexpr (L) {
+            ct_store_uint<8, L>(out, n);
+            memset(out + 8, fill, Op.size - 8);
+        } else {
+            memset(out, fill, Op.size - 8);
+            ct_store_uint<8, L>(out + Op.size - 8, n);
+        }
+    }
+}
+
+/// PackFmtParser::unpackint
+template <PackOp Op, bool Signed>
+inline int64_t ct_unpackint(const char* p) {
+    constexpr bool L = Op.islittle != 0;
+    uint64_t res;
+    if constexpr (Op.size <= 8) {
+        res = ct_load_uint<Op.size, L>(p);
+    } else {
+        res = ct_load_uint<8, L>(L ? p : p + Op.size - 8);
+    }
+    if constexpr (Op.size < 8 && Signed) {
+        constexpr uint64_t mask = (uint64_t)1 << (Op.size * 8 - 1);
+        res                     = (res ^ mask) - mask;
+    } else if constexpr (Op.size > 8) {
+        const char mask   = (!Signed || (int64_t)res >= 0) ? 0 : (char)0xff;
+        const char* extra = L ? p + 8 : p;
+        for (size_t i = 0; i < Op.size - 8; ++i) {
+            if (extra[i] != mask) {
+                throw std::runtime_error(std::to_string(Op.size)
+                                         + "-byte integer does not fit into Integer");
+            }
+        }
+    }
+    return (int64_t)res;
+}
+
+template <fixed_string F, typename Tuple>
+inline size_t ct_pack_size(const Tuple& args) {
+    constexpr auto& fmt = ct_format_v<F>;
+    if constexpr (fmt.fixed) {
+        return fmt.size;
+    } else {
+        size_t pos = 0;
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            const auto f = [&](auto i) {
+                constexpr PackOp op = ct_format_v<F>.ops[i];
+                pos += pack_ntoalign(pos, op.align);
+                if constexpr (op.op == Kpadding || op.op == Kpaddalign) {
+                    pos += op.size;
+                } else {
+                    pos += pack_argsize(op, std::get<ct_value_index(ct_format_v<F>, i)>(args));
+                }
+            };
+            (f(std::integral_constant<size_t, I>{}), ...);
+        }(std::make_index_sequence<fmt.count>{});
+        return pos;
+    }
+}
+
+template <PackOp Op, typename T>
+inline void ct_packvalue(char* out, size_t& pos, const T& v) {
+    using U = std::remove_cv_t<std::remove_reference_t<T>>;
+    if constexpr (Op.op == Kvarint || Op.op == Kzigzag) {
+        static_assert(std::is_arithmetic_v<U>, "str_pack: numeric option expects a number");
+        pos += varint_write(out + pos, Op.op == Kzigzag ? zigzag_encode((int64_t)v) : (uint64_t)v);
+    } else if constexpr (Op.op == Kint || Op.op == Kuint || Op.op == Kfloat || Op.op == Kdouble) {
+        static_assert(std::is_arithmetic_v<U>, "str_pack: numeric option expects a number");
+        if constexpr (Op.op == Kfloat) {
+            const float f = (float)v;
+            uint32_t u;
+            memcpy(&u, &f, sizeof(f));
+            ct_store_uint<4, (bool)Op.islittle>(out + pos, u);
+        } else if constexpr (Op.op == Kdouble) {
+            const double d = (double)v;
+            uint64_t u;
+            memcpy(&u, &d, sizeof(d));
+            ct_store_uint<8, (bool)Op.islittle>(out + pos, u);
+        } else if constexpr (std::is_floating_point_v<U>) {
+            ct_packint<Op>(out + pos, (uint64_t)(int64_t)v, Op.op == Kint && v < 0);
+        } else if constexpr (std::is_signed_v<U>) {
+            ct_packint<Op>(out + pos, (uint64_t)v, Op.op == Kint && v < 0);
+        } else {
+            ct_packint<Op>(out + pos, (uint64_t)v, false);
+        }
+        pos += Op.size;
+    } else {
+        static_assert(std::is_convertible_v<const U&, std::string_view>,
+                      "str_pack: string option expects a string");
+        const std::string_view s = v;
+        if constexpr (Op.op == Kchar) {
+            if constexpr (std::is_array_v<U>) {
+                static_assert(std::extent_v<U> - 1 <= Op.size, "cn: string longer than given size");
+            }
+            if (s.size() > Op.size) {
+                throw std::runtime_error("cn: string longer than given size");
+            }
+            memcpy(out + pos, s.data(), s.size());
+            memset(out + pos + s.size(), 0, Op.size - s.size());
+            pos += Op.size;
+        } else if constexpr (Op.op == Kstring) {
+            ct_packint<Op>(out + pos, (uint64_t)s.size(), false);
+            pos += Op.size;
+            memcpy(out + pos, s.data(), s.size());
+            pos += s.size();
+        } else if constexpr (Op.op == Kvstring) {
+            pos += varint_write(out + pos, s.size());
+            memcpy(out + pos, s.data(), s.size());
+            pos += s.size();
+        } else {
+            memcpy(out + pos, s.data(), s.size());
+            out[pos + s.size()] = '\0';
+            pos += s.size() + 1;
+        }
+    }
+}
+
+/// writes ct_pack_size<F>(args) bytes
+template <fixed_string F, typename Tuple>
+inline void ct_pack(char* out, const Tuple& args) {
+    size_t pos = 0;
+    [&]<size_t... I>(std::index_sequence<I...>) {
+        const auto f = [&](auto i) {
+            constexpr PackOp op = ct_format_v<F>.ops[i];
+            if constexpr (op.align > 1) {
+                const size_t n = pack_ntoalign(pos, op.align);
+                memset(out + pos, 0, n);
+                pos += n;
+            }
+            if constexpr (op.op == Kpadding) {
+                out[pos++] = 0;
+            } else if constexpr (op.op != Kpaddalign) {
+                ct_packvalue<op>(out, pos, std::get<ct_value_index(ct_format_v<F>, i)>(args));
+            }
+        };
+        (f(std::integral_constant<size_t, I>{}), ...);
+    }(std::make_index_sequence<ct_format_v<F>.count>{});
+}
+
+template <PackOp Op, bool Checked, typename U>
+inline void ct_unpackvalue(std::string_view s, size_t& pos, U& v) {
+    const char* p = s.data() + pos;
+    if constexpr (Checked && Op.op != Kzstr) {
+        if (pos + Op.size > s.size()) {
+            ct_overflow(pos + Op.size, s.size());
+        }
+    }
+    if constexpr (Op.op == Kvarint || Op.op == Kzigzag) {
+        static_assert(std::is_arithmetic_v<U>, "str_unpack: numeric option expects a number");
+        uint64_t x;
+        const size_t n = varint_read(p, s.size() - pos, x);
+        if (n == 0) {
+            ct_overflow(s.size() + 1, s.size());
+        }
+        if constexpr (Op.op == Kzigzag) {
+            v = static_cast<U>(zigzag_decode(x));
+        } else {
+            v = static_cast<U>(x);
+        }
+        pos += n;
+    } else if constexpr (Op.op == Kint || Op.op == Kuint || Op.op == Kfloat || Op.op == Kdouble) {
+        static_assert(std::is_arithmetic_v<U>, "str_unpack: numeric option expects a number");
+        if constexpr (Op.op == Kfloat) {
+            const uint32_t u = (uint32_t)ct_load_uint<4, (bool)Op.islittle>(p);
+            float f;
+            memcpy(&f, &u, sizeof(f));
+            v = static_cast<U>(f);
+        } else if constexpr (Op.op == Kdouble) {
+            const uint64_t u = ct_load_uint<8, (bool)Op.islittle>(p);
+            double d;
+            memcpy(&d, &u, sizeof(d));
+            v = static_cast<U>(d);
+        } else {
+            v = static_cast<U>(ct_unpackint<Op, Op.op == Kint>(p));
+        }
+        pos += Op.size;
+    } else {
+        static_assert(std::is_same_v<U, std::string> || std::is_same_v<U, std::vector<char>>
+                          || std::is_same_v<U, std::string_view>,
+                      "str_unpack: string option expects std::string, std::string_view or "
+                      "std::vector<char>");
+        size_t len = Op.size;
+        if constexpr (Op.op == Kstring) {
+            len = (size_t)ct_unpackint<Op, false>(p);
+            p += Op.size;
+            pos += Op.size;
+            if (pos + len > s.size()) {
+                ct_overflow(pos + len, s.size());
+            }
+        } else if constexpr (Op.op == Kvstring) {
+            uint64_t x;
+            const size_t n = varint_read(p, s.size() - pos, x);
+            if (n == 0 || x > s.size() - pos - n) {
+                ct_overflow(n == 0 ? s.size() + 1 : pos + n + x, s.size());
+            }
+            len = (size_t)x;
+            p += n;
+            pos += n;
+        } else if constexpr (Op.op == Kzstr) {
+            len = find_nul(p, s.size() - pos);
+            if (pos + len == s.size()) {
+                ct_overflow(s.size() + 1, s.size());
+            }
+        }
+        if constexpr (std::is_same_v<U, std::string_view>) {
+            v = std::string_view(p, len);
+        } else {
+            v.assign(p, p + len);
+        }
+        pos += len + (Op.op == Kzstr);
+    }
+}
+
+template <fixed_string F, typename Tuple>
+inline void ct_unpack(std::string_view s, size_t& pos, Tuple& res) {
+    constexpr auto& fmt = ct_format_v<F>;
+    if constexpr (fmt.fixed) {
+        if (s.size() < fmt.size) {
+            ct_overflow(fmt.size, s.size());
+        }
+    }
+    [&]<size_t... I>(std::index_sequence<I...>) {
+        const auto f = [&](auto i) {
+            constexpr PackOp op = ct_format_v<F>.ops[i];
+            constexpr bool checked = !ct_format_v<F>.fixed;
+            pos += pack_ntoalign(pos, op.align);
+            if constexpr (op.op == Kpadding || op.op == Kpaddalign) {
+                pos += op.size;
+                if (checked && pos > s.size()) {
+                    ct_overflow(pos, s.size());
+                }
+            } else {
+                ct_unpackvalue<op, checked>(s, pos,
+                                            std::get<ct_value_index(ct_format_v<F>, i)>(res));
+            }
+        };
+        (f(std::integral_constant<size_t, I>{}), ...);
+    }(std::make_index_sequence<fmt.count>{});
+}
+
+}  // namespace detail
+
+template <detail::fixed_string F, typename... Args>
+size_t str_pack_size(const Args&... args) {
+    static_assert(sizeof...(Args) == detail::ct_format_v<F>.nvalues,
+                  "str_pack: argument count does not match the format");
+    return detail::ct_pack_size<F>(std::forward_as_tuple(args...));
+}
+
+template <detail::fixed_string F, typename... Args>
+size_t str_pack_into(char* out, size_t len, const Args&... args) {
+    const size_t n = str_pack_size<F>(args...);
+    if (n > len) {
+        throw std::runtime_error("Buffer too small");
+    }
+    detail::ct_pack<F>(out, std::forward_as_tuple(args...));
+    return n;
+}
+
+template <detail::fixed_string F, typename Buffer, typename... Args>
+size_t str_pack_append(Buffer& b, const Args&... args) {
+    const size_t n = str_pack_size<F>(args...);
+    return detail::pack_grow_write(b, n, [&](char* out) {
+        detail::ct_pack<F>(out, std::forward_as_tuple(args...));
+        return n;
+    });
+}
+
+template <detail::fixed_string F, typename... Args>
+std::vector<char>  //
+str_pack(const Args&... args) {
+    std::vector<char> result;
+    str_pack_append<F>(result, args...);
+    return result;
+}
+
+template <detail::fixed_string F, typename... Args>
+std::tuple<std::decay_t<Args>..., int>  //
+str_unpack(std::string_view data) {
+    static_assert(sizeof...(Args) == detail::ct_format_v<F>.nvalues,
+                  "str_unpack: argument count does not match the format");
+    std::tuple<std::decay_t<Args>...> res;
+    size_t pos = 0;
+    detail::ct_unpack<F>(data, pos, res);
+    return std::tuple_cat(std::move(res), std::make_tuple((int)pos));
+}
+
+template <detail::fixed_string F, typename... Args>
+std::tuple<std::decay_t<Args>..., int>  //
+str_unpack(const std::vector<char>& data) {
+    return str_unpack<F, Args...>(std::string_view(data.data(), data.size()));
+}
+
+#endif
+
 }  // namespace lc
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <lcrypt/base.h>
+
+namespace lc {
+
+// Random tokens (session ids, nonces) from secure_random_bytes, `n` is the number of
+// random bytes in a token.
+
+inline size_t token_hex_size(size_t n) {
+    return 2 * n;
+}
+
+/// Unpadded
+inline size_t token_base64url_size(size_t n) {
+    return (4 * n + 2) / 3;
+}
+
+std::string random_token_hex(size_t n);
+std::string random_token_base64url(size_t n);
+
+/// `count` tokens back to back in one string, token i is
+/// arena.substr(i * token_hex_size(n), token_hex_size(n))
+std::string random_tokens_hex(size_t count, size_t n);
+/// Token i is arena.substr(i * token_base64url_size(n), token_base64url_size(n))
+std::string random_tokens_base64url(size_t count, size_t n);
+
+}  // namespace lc
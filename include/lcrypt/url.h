@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <lcrypt/base.h>
+
+namespace lc {
+
+/// Percent-encodes all bytes but the RFC 3986 unreserved ones (ALPHA DIGIT - . _ ~),
+/// `form` encodes ' ' as '+' (application/x-www-form-urlencoded).
+std::string url_encode(const char* buf, size_t len, bool form = false);
+/// Throws input_error on a '%' not followed by two hex digits, `form` decodes '+' as ' '.
+std::string url_decode(const char* buf, size_t len, bool form = false);
+
+size_t url_encode_size(const char* buf, size_t len, bool form = false);
+
+/// Returns `s` itself when nothing needs encoding, otherwise the result is written to `buf`.
+std::string_view url_encode(std::string_view s, std::string& buf, bool form = false);
+/// Returns `s` itself when nothing needs decoding, otherwise the result is written to `buf`.
+std::string_view url_decode(std::string_view s, std::string& buf, bool form = false);
+
+using url_params = std::vector<std::pair<std::string_view, std::string_view>>;
+
+/// Splits "k1=v1&k2=v2" into pairs, empty items are skipped and a key without '=' gets an
+/// empty value. Keys and values without escapes are views into `query`, the others are
+/// form-decoded into `buf`, so both must outlive the result and `buf` must not be modified.
+url_params url_parse_query(std::string_view query, std::string& buf);
+
+template <typename V>
+std::string url_encode(const V& v, bool form = false) {
+    auto s = to_span(v);
+    return url_encode(s.data(), s.size(), form);
+}
+
+template <typename V>
+std::string url_decode(const V& v, bool form = false) {
+    auto s = to_span(v);
+    return url_decode(s.data(), s.size(), form);
+}
+
+template <typename V>
+size_t url_encode_size(const V& v, bool form = false) {
+    auto s = to_span(v);
+    return url_encode_size(s.data(), s.size(), form);
+}
+
+}  // namespace lc
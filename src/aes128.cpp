@@ -1,9 +1,14 @@
 #include "lcrypt/aes128.h"
+#include "detail/entropy.h"
 #include <array>
+#include <atomic>
 #include <stdexcept>
 #include <hwy/highway.h>
 #include <stdint.h>
 #include <string.h>
+#if !defined(_WIN32)
+#include <pthread.h>
+#endif
 
 namespace hn = hwy::HWY_NAMESPACE;
 
@@ -21,6 +26,7 @@ struct aes128 {
         hwy::CopyBytes(key.data(), keyb, HWY_MIN(key.size(), 16));
         keys_t key_schedule;
         key_schedule[0]  = hn::LoadDup128(_d8, keyb);
+        lc::detail::secure_zero(keyb, 16);
         key_schedule[1]  = key_expansion<0x01>(key_schedule[0]);
         key_schedule[2]  = key_expansion<0x02>(key_schedule[1]);
         key_schedule[3]  = key_expansion<0x04>(key_schedule[2]);
@@ -58,21 +64,6 @@ struct aes128 {
         const uint8_t* src = reinterpret_cast<const uint8_t*>(plain.data());
         uint8_t* dest      = reinterpret_cast<uint8_t*>(result.data());
 
-        static constexpr auto enc_blk = [](auto in, const auto& key_schedule) {
-            in = hn::Xor(in, key_schedule[0]);
-            in = hn::AESRound(in, key_schedule[1]);
-            in = hn::AESRound(in, key_schedule[2]);
-            in = hn::AESRound(in, key_schedule[3]);
-            in = hn::AESRound(in, key_schedule[4]);
-            in = hn::AESRound(in, key_schedule[5]);
-            in = hn::AESRound(in, key_schedule[6]);
-            in = hn::AESRound(in, key_schedule[7]);
-            in = hn::AESRound(in, key_schedule[8]);
-            in = hn::AESRound(in, key_schedule[9]);
-            in = hn::AESLastRound(in, key_schedule[10]);
-            return in;
-        };
-
         while (idx + N8 - 1 < len) {
             auto in = hn::LoadU(_d8, src + idx);
             in      = enc_blk(in, key_schedule);
@@ -96,6 +87,39 @@ struct aes128 {
         return result;
     }
 
+    static vec_t enc_blk(vec_t in, const keys_t& key_schedule) {
+        in = hn::Xor(in, key_schedule[0]);
+        in = hn::AESRound(in, key_schedule[1]);
+        in = hn::AESRound(in, key_schedule[2]);
+        in = hn::AESRound(in, key_schedule[3]);
+        in = hn::AESRound(in, key_schedule[4]);
+        in = hn::AESRound(in, key_schedule[5]);
+        in = hn::AESRound(in, key_schedule[6]);
+        in = hn::AESRound(in, key_schedule[7]);
+        in = hn::AESRound(in, key_schedule[8]);
+        in = hn::AESRound(in, key_schedule[9]);
+        in = hn::AESLastRound(in, key_schedule[10]);
+        return in;
+    }
+
+    /// Four independent vectors a round at a time, the AES units overlap their latencies
+    static void enc_blk4(vec_t& a, vec_t& b, vec_t& c, vec_t& d, const keys_t& key_schedule) {
+        a = hn::Xor(a, key_schedule[0]);
+        b = hn::Xor(b, key_schedule[0]);
+        c = hn::Xor(c, key_schedule[0]);
+        d = hn::Xor(d, key_schedule[0]);
+        for (size_t r = 1; r < 10; ++r) {
+            a = hn::AESRound(a, key_schedule[r]);
+            b = hn::AESRound(b, key_schedule[r]);
+            c = hn::AESRound(c, key_schedule[r]);
+            d = hn::AESRound(d, key_schedule[r]);
+        }
+        a = hn::AESLastRound(a, key_schedule[10]);
+        b = hn::AESLastRound(b, key_schedule[10]);
+        c = hn::AESLastRound(c, key_schedule[10]);
+        d = hn::AESLastRound(d, key_schedule[10]);
+    }
+
     static inline std::vector<uint8_t>  //
     encrypt(std::string_view plain, std::string_view key) {
         return encrypt(plain, load_key(key));
@@ -150,7 +174,62 @@ struct aes128 {
         return decrypt(cipher, load_key(key));
     }
 
+    /// `n` bytes of AES(key, V + 1) || AES(key, V + 2) ..., `v` is a 128 bit big-endian
+    /// counter and ends at the last block used
+    static void ctr(const keys_t& key_schedule, uint8_t* v, uint8_t* out, size_t n) {
+        static constexpr size_t kBatch = 4 * N8;
+        HWY_ALIGN uint8_t blocks[kBatch] = {0};
+        uint64_t hi                      = load_be64(v);
+        uint64_t lo                      = load_be64(v + 8);
+        const auto next                  = [&](size_t nblocks) {
+            for (size_t k = 0; k < nblocks; ++k) {
+                hi += (++lo == 0);
+                store_be64(blocks + 16 * k, hi);
+                store_be64(blocks + 16 * k + 8, lo);
+            }
+        };
+
+        size_t i = 0;
+        for (; i + kBatch <= n; i += kBatch) {
+            next(kBatch / 16);
+            auto a = hn::Load(_d8, blocks);
+            auto b = hn::Load(_d8, blocks + N8);
+            auto c = hn::Load(_d8, blocks + 2 * N8);
+            auto d = hn::Load(_d8, blocks + 3 * N8);
+            enc_blk4(a, b, c, d, key_schedule);
+            hn::StoreU(a, _d8, out + i);
+            hn::StoreU(b, _d8, out + i + N8);
+            hn::StoreU(c, _d8, out + i + 2 * N8);
+            hn::StoreU(d, _d8, out + i + 3 * N8);
+        }
+        if (i != n) {
+            const size_t remaining = n - i;
+            next((remaining + 15) / 16);
+            for (size_t k = 0; k < remaining; k += N8) {
+                auto in = enc_blk(hn::Load(_d8, blocks + k), key_schedule);
+                hn::StoreN(in, _d8, out + i + k, HWY_MIN(N8, remaining - k));
+            }
+        }
+        store_be64(v, hi);
+        store_be64(v + 8, lo);
+        lc::detail::secure_zero(blocks, sizeof(blocks));
+    }
+
 private:
+    static uint64_t load_be64(const uint8_t* p) {
+        uint64_t x = 0;
+        for (int i = 0; i < 8; ++i) {
+            x = (x << 8) | p[i];
+        }
+        return x;
+    }
+
+    static void store_be64(uint8_t* p, uint64_t x) {
+        for (int i = 7; i >= 0; --i, x >>= 8) {
+            p[i] = (uint8_t)x;
+        }
+    }
+
     template <uint8_t Rcon>
     static vec_t key_expansion(vec_t key) {
         auto keygened = hn::AESKeyGenAssist<Rcon>(key);
@@ -175,4 +254,158 @@ aes128_dec(const char* cipher, size_t cipher_size, const char* key, size_t key_s
     return aes128::decrypt(std::string_view(cipher, cipher_size), std::string_view(key, key_size));
 }
 
+// ctr_drbg
+
+namespace {
+
+/// CTR_DRBG_Update: (Key, V) = the next 32 bytes of the counter stream ^ `provided`
+void drbg_update(const aes128::keys_t& ks, uint8_t* key, uint8_t* v, const uint8_t* provided) {
+    uint8_t temp[lc::ctr_drbg::kSeedLen];
+    aes128::ctr(ks, v, temp, sizeof(temp));
+    if (provided) {
+        for (size_t i = 0; i < sizeof(temp); ++i) {
+            temp[i] ^= provided[i];
+        }
+    }
+    memcpy(key, temp, 16);
+    memcpy(v, temp + 16, 16);
+    detail::secure_zero(temp, sizeof(temp));
+}
+
+/// `entropy` ^ `extra`, padded with zeros
+void seed_material(uint8_t* out, const uint8_t* entropy, std::string_view extra) {
+    if (HWY_UNLIKELY(extra.size() > lc::ctr_drbg::kSeedLen)) {
+        throw std::invalid_argument("ctr_drbg: more than 32 bytes of input");
+    }
+    memcpy(out, entropy, lc::ctr_drbg::kSeedLen);
+    for (size_t i = 0; i < extra.size(); ++i) {
+        out[i] ^= (uint8_t)extra[i];
+    }
+}
+
+#if !defined(_WIN32)
+/// Bumped in the child of a fork(), the thread states reseed when they see it move
+std::atomic<uint64_t> fork_generation{0};
+#endif
+
+uint64_t current_fork_generation() {
+#if defined(_WIN32)
+    return 0;
+#else
+    static const bool registered = [] {
+        pthread_atfork(nullptr, nullptr, [] { fork_generation.fetch_add(1); });
+        return true;
+    }();
+    (void)registered;
+    return fork_generation.load(std::memory_order_relaxed);
+#endif
+}
+
+/// Small requests are served from a buffer filled by one generate() call, the bytes
+/// handed out are wiped.
+struct secure_state {
+    static constexpr size_t kBuffer = 4096;
+    static constexpr size_t kSmall  = 256;
+
+    lc::ctr_drbg drbg;
+    uint64_t generation = current_fork_generation();
+    size_t pos          = kBuffer;
+    uint8_t buf[kBuffer];
+
+    ~secure_state() { detail::secure_zero(buf, sizeof(buf)); }
+
+    void generate(uint8_t* out, size_t n) {
+        const uint64_t g = current_fork_generation();
+        if (HWY_UNLIKELY(g != generation)) {
+            generation = g;
+            detail::secure_zero(buf + pos, kBuffer - pos);
+            pos = kBuffer;
+            drbg.reseed();
+        }
+        if (n <= kSmall) {
+            if (pos + n > kBuffer) {
+                fill(buf, kBuffer);
+                pos = 0;
+            }
+            memcpy(out, buf + pos, n);
+            detail::secure_zero(buf + pos, n);
+            pos += n;
+            return;
+        }
+        while (n != 0) {
+            const size_t k = HWY_MIN(n, lc::ctr_drbg::kMaxRequest);
+            fill(out, k);
+            out += k;
+            n -= k;
+        }
+    }
+
+    void fill(uint8_t* out, size_t n) {
+        if (drbg.reseed_counter() > lc::ctr_drbg::kReseedInterval) {
+            drbg.reseed();
+        }
+        drbg.generate(out, n);
+    }
+};
+
+}  // namespace
+
+ctr_drbg::ctr_drbg() {
+    uint8_t entropy[kSeedLen];
+    detail::os_entropy(entropy, kSeedLen);
+    instantiate(entropy, {});
+    detail::secure_zero(entropy, kSeedLen);
+}
+
+ctr_drbg::ctr_drbg(const uint8_t* entropy, std::string_view personalization) {
+    instantiate(entropy, personalization);
+}
+
+ctr_drbg::~ctr_drbg() {
+    detail::secure_zero(key_, sizeof(key_));
+    detail::secure_zero(v_, sizeof(v_));
+}
+
+void ctr_drbg::instantiate(const uint8_t* entropy, std::string_view personalization) {
+    memset(key_, 0, sizeof(key_));
+    memset(v_, 0, sizeof(v_));
+    reseed(entropy, personalization);
+}
+
+void ctr_drbg::reseed() {
+    uint8_t entropy[kSeedLen];
+    detail::os_entropy(entropy, kSeedLen);
+    reseed(entropy, {});
+    detail::secure_zero(entropy, kSeedLen);
+}
+
+void ctr_drbg::reseed(const uint8_t* entropy, std::string_view additional) {
+    uint8_t seed[kSeedLen];
+    seed_material(seed, entropy, additional);
+    auto ks = aes128::load_key(std::string_view((const char*)key_, sizeof(key_)));
+    drbg_update(ks, key_, v_, seed);
+    detail::secure_zero(seed, kSeedLen);
+    detail::secure_zero(&ks, sizeof(ks));
+    reseed_counter_ = 1;
+}
+
+void ctr_drbg::generate(void* out, size_t n) {
+    if (HWY_UNLIKELY(n > kMaxRequest)) {
+        throw std::invalid_argument("ctr_drbg: request too large");
+    }
+    if (HWY_UNLIKELY(reseed_counter_ > kReseedInterval)) {
+        throw std::runtime_error("ctr_drbg: reseed required");
+    }
+    auto ks = aes128::load_key(std::string_view((const char*)key_, sizeof(key_)));
+    aes128::ctr(ks, v_, (uint8_t*)out, n);
+    drbg_update(ks, key_, v_, nullptr);
+    detail::secure_zero(&ks, sizeof(ks));
+    reseed_counter_++;
+}
+
+void secure_random_bytes(void* buf, size_t n) {
+    thread_local secure_state state;
+    state.generate((uint8_t*)buf, n);
+}
+
 }  // namespace lc
@@ -1,13 +1,89 @@
 #include "lcrypt/base.h"
+#include "detail/entropy.h"
+#include "detail/hwy.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
 #include <hwy/contrib/random/random-inl.h>
 #include <time.h>
-
-namespace hn = hwy::HWY_NAMESPACE;
+#if defined(_WIN32)
+#include <random>
+#elif defined(__linux__)
+#include <errno.h>
+#include <sys/random.h>
+#else
+#include <stdlib.h>
+#endif
 
 namespace {
 
 inline uint64_t GetSeed() {
-    return static_cast<uint64_t>(time(nullptr));
+    return lc::random_seed();
+}
+
+/// The streams of the live threads. A thread takes the lowest free id and gives it back on
+/// exit, so the ids, and the long jumps to reach them, stay below the peak number of threads.
+/// An id also counts its uses, a thread that gets it again reseeds instead of replaying the
+/// draws of the one before.
+class stream_ids {
+public:
+    std::pair<uint64_t, uint64_t> acquire() {
+        std::lock_guard<std::mutex> lock(mu_);
+        uint64_t id = uses_.size();
+        if (free_.empty()) {
+            uses_.push_back(0);
+        } else {
+            std::pop_heap(free_.begin(), free_.end(), std::greater<uint64_t>());
+            id = free_.back();
+            free_.pop_back();
+        }
+        return {id, uses_[id]++};
+    }
+
+    void release(uint64_t id) {
+        std::lock_guard<std::mutex> lock(mu_);
+        free_.push_back(id);
+        std::push_heap(free_.begin(), free_.end(), std::greater<uint64_t>());
+    }
+
+    /// Never destroyed, threads may exit after the statics are gone
+    static stream_ids& get() {
+        static stream_ids* ids = new stream_ids;
+        return *ids;
+    }
+
+private:
+    std::mutex mu_;
+    std::vector<uint64_t> free_; /* min heap */
+    std::vector<uint64_t> uses_;
+};
+
+/// The stream id of the thread, shared by all its generators
+struct thread_stream {
+    uint64_t id, use;
+
+    thread_stream() { std::tie(id, use) = stream_ids::get().acquire(); }
+    ~thread_stream() { stream_ids::get().release(id); }
+
+    static const thread_stream& get() {
+        thread_local thread_stream s;
+        return s;
+    }
+};
+
+/// One generator of each type per thread, every type with its own seed. A thread takes the
+/// stream of its id, the streams are 2^192 draws apart so they never overlap.
+template <typename G>
+inline G& thread_generator() {
+    static const uint64_t seed = GetSeed();
+    const thread_stream& s     = thread_stream::get();
+    thread_local G generator{seed ^ (s.use * 0xd1b54a32d192ed03), s.id};
+    return generator;
 }
 
 template <std::uint64_t size = 1024>
@@ -23,7 +99,7 @@ public:
 
     result_type operator()() noexcept {
         if (HWY_UNLIKELY(index_ == size)) {
-            cache_ = std::move(generator_.Uniform<size>());
+            cache_ = generator_.Uniform<size>();
             index_ = 0;
         }
         return cache_[index_++];
@@ -39,25 +115,274 @@ private:
 
 inline double random_impl() {
 #if HWY_HAVE_FLOAT64
-    static FloatCachedXoshiro<> generator{GetSeed()};
-    return generator();
+    return thread_generator<FloatCachedXoshiro<>>()();
 #else
-    static hn::CachedXoshiro<64> generator{GetSeed()};
     static constexpr uint64_t max = hwy::LimitsMax<uint64_t>();
-    return ((double)generator() * (1.0 / ((double)max + 1.0)));
+    return ((double)thread_generator<hn::CachedXoshiro<64>>()() * (1.0 / ((double)max + 1.0)));
 #endif
 }
 
-inline size_t random_impl(size_t m, size_t n) {
-    double r = random_impl();
-    r *= (double)(n - m) + 1.0;
-    return m + (size_t)r;
+/// Lemire's multiply-shift, [0, range) from the 64 bit draw `x` without bias: the few `x`
+/// landing in the short last interval are redrawn from `g`.
+template <typename G>
+inline uint64_t bounded(uint64_t x, uint64_t range, G& g) {
+    uint64_t hi;
+    uint64_t lo = hwy::Mul128(x, range, &hi);
+    if (HWY_UNLIKELY(lo < range)) {
+        const uint64_t t = (0 - range) % range;
+        while (lo < t) {
+            lo = hwy::Mul128(g(), range, &hi);
+        }
+    }
+    return hi;
+}
+
+/// [m, n], the full 64 bits when n - m + 1 wraps to 0
+inline uint64_t random_impl(uint64_t m, uint64_t n) {
+    auto& g              = thread_generator<hn::CachedXoshiro<>>();
+    const uint64_t range = n - m + 1;
+    return m + (range ? bounded(g(), range, g) : g());
+}
+
+// Bulk fills from a generator of vectors, `g()` returns the next Vec of uint64_t
+
+template <typename G>
+void fill_bytes(G& g, void* buf, size_t n) {
+    using D = hn::DFromV<decltype(g())>;
+    const hn::Repartition<uint8_t, D> d8;
+    const size_t N8 = hn::Lanes(d8);
+    uint8_t* p      = (uint8_t*)buf;
+    size_t i        = 0;
+    for (; i + N8 <= n; i += N8) {
+        hn::StoreU(hn::BitCast(d8, g()), d8, p + i);
+    }
+    if (i != n) {
+        hn::StoreN(hn::BitCast(d8, g()), d8, p + i, n - i);
+    }
+}
+
+/// [0, 1), the top 53 bits of every draw
+template <typename G>
+void fill_doubles(G& g, double* out, size_t n) {
+    using D = hn::DFromV<decltype(g())>;
+    const D d;
+    const size_t N = hn::Lanes(d);
+    size_t i       = 0;
+#if HWY_HAVE_FLOAT64
+    const hn::Rebind<double, D> df;
+    const hn::Rebind<int64_t, D> di;
+    const auto scale = hn::Set(df, 0x1.0p-53);
+    const auto f     = [&] {
+        return hn::Mul(hn::ConvertTo(df, hn::BitCast(di, hn::ShiftRight<11>(g()))), scale);
+    };
+    for (; i + N <= n; i += N) {
+        hn::StoreU(f(), df, out + i);
+    }
+    if (i != n) {
+        hn::StoreN(f(), df, out + i, n - i);
+    }
+#else
+    HWY_ALIGN uint64_t tmp[hn::MaxLanes(d)];
+    for (; i < n; i += N) {
+        hn::Store(g(), d, tmp);
+        for (size_t k = 0; k < N && i + k < n; ++k) {
+            out[i + k] = (double)(tmp[k] >> 11) * 0x1.0p-53;
+        }
+    }
+#endif
+}
+
+/// [lo, hi], `sg()` gives single 64 bit draws for the rejections and the tail
+template <typename G, typename SG>
+void fill_ints(G& g, SG& sg, int64_t* out, size_t n, int64_t lo, int64_t hi) {
+    if (HWY_UNLIKELY(lo > hi)) {
+        throw std::invalid_argument("random: lo > hi");
+    }
+    const uint64_t range = (uint64_t)hi - (uint64_t)lo + 1;
+    size_t i             = 0;
+    if (range != 0 && range <= UINT32_MAX) {
+        // 32 bit draws, x * range >> 32, rejected when the low half is below 2^32 % range
+        using D = hn::DFromV<decltype(g())>;
+        const D d64;
+        const hn::Repartition<uint32_t, D> d32;
+        const hn::Half<decltype(d32)> dh;
+        const size_t N   = hn::Lanes(d32);
+        const uint32_t t = (0 - (uint32_t)range) % (uint32_t)range;
+        const auto vr    = hn::Set(d32, (uint32_t)range);
+        const auto vt    = hn::Set(d32, t);
+        const auto vbase = hn::Set(d64, (uint64_t)lo);
+        uint64_t* o      = (uint64_t*)out;
+        // blocks of at least 8 draws, whole rounds of rng::lanes
+        const size_t nv = HWY_MAX(size_t(1), 8 / hn::Lanes(d64));
+        for (; i + nv * N <= n; i += nv * N) {
+            uint64_t rejected = 0;
+            for (size_t v = 0; v < nv; ++v) {
+                const auto x = hn::BitCast(d32, g());
+                const auto h = hn::MulHigh(x, vr);
+                rejected |= MaskBits(d32, hn::Lt(hn::Mul(x, vr), vt)) << (v * N);
+                uint64_t* p = o + i + v * N;
+                hn::StoreU(hn::Add(vbase, hn::PromoteTo(d64, hn::LowerHalf(dh, h))), d64, p);
+                hn::StoreU(hn::Add(vbase, hn::PromoteTo(d64, hn::UpperHalf(dh, h))), d64, p + N / 2);
+            }
+            // rare, redrawn in lane order once the block is done
+            for (; rejected != 0; rejected &= rejected - 1) {
+                o[i + hwy::Num0BitsBelowLS1Bit_Nonzero64(rejected)] =
+                    (uint64_t)lo + bounded(sg(), range, sg);
+            }
+        }
+    } else if (range == 0) {
+        fill_bytes(g, out, n * sizeof(int64_t));
+        return;
+    }
+    for (; i < n; ++i) {
+        out[i] = (int64_t)((uint64_t)lo + bounded(sg(), range, sg));
+    }
+}
+
+/// out[k] uniform in [0, top - k]. Ranges below 2^32 take 32 bit draws like fill_ints, the
+/// exact threshold of a lane is only worked out when its low product is below the range.
+template <typename G, typename SG>
+void fill_descending(G& g, SG& sg, uint64_t* out, size_t n, uint64_t top) {
+    size_t i = 0;
+    for (; i < n && top - i >= UINT32_MAX; ++i) {
+        out[i] = bounded(sg(), top - i + 1, sg);
+    }
+    using D = hn::DFromV<decltype(g())>;
+    const D d64;
+    const hn::Repartition<uint32_t, D> d32;
+    const hn::Half<decltype(d32)> dh;
+    const size_t N  = hn::Lanes(d32);
+    const size_t nv = HWY_MAX(size_t(1), 8 / hn::Lanes(d64));
+    HWY_ALIGN uint32_t xs[HWY_MAX(16, hn::MaxLanes(d32))];
+    for (; i + nv * N <= n; i += nv * N) {
+        auto vr           = hn::Sub(hn::Set(d32, (uint32_t)(top - i + 1)), hn::Iota(d32, 0));
+        uint64_t rejected = 0;
+        for (size_t v = 0; v < nv; ++v) {
+            const auto x       = hn::BitCast(d32, g());
+            const auto h       = hn::MulHigh(x, vr);
+            const uint64_t low = MaskBits(d32, hn::Lt(hn::Mul(x, vr), vr));
+            if (HWY_UNLIKELY(low != 0)) {
+                hn::StoreU(x, d32, xs + v * N);
+                rejected |= low << (v * N);
+            }
+            uint64_t* p = out + i + v * N;
+            hn::StoreU(hn::PromoteTo(d64, hn::LowerHalf(dh, h)), d64, p);
+            hn::StoreU(hn::PromoteTo(d64, hn::UpperHalf(dh, h)), d64, p + N / 2);
+            vr = hn::Sub(vr, hn::Set(d32, (uint32_t)N));
+        }
+        for (; rejected != 0; rejected &= rejected - 1) {
+            const size_t k       = hwy::Num0BitsBelowLS1Bit_Nonzero64(rejected);
+            const uint32_t range = (uint32_t)(top - i - k + 1);
+            if ((uint32_t)(xs[k] * range) < (0 - range) % range) {
+                out[i + k] = bounded(sg(), range, sg);
+            }
+        }
+    }
+    for (; i < n; ++i) {
+        out[i] = bounded(sg(), top - i + 1, sg);
+    }
+}
+
+/// A partial Fisher-Yates over [0, n), `draw` is one of the shuffle_draws
+template <typename Draw>
+std::vector<size_t> sample_indices_impl(Draw&& draw, size_t n, size_t k) {
+    if (HWY_UNLIKELY(k > n)) {
+        throw std::invalid_argument("sample_indices: k > n");
+    }
+    uint64_t r[256];
+    if (k >= n / 8) {
+        std::vector<size_t> idx(n);
+        std::iota(idx.begin(), idx.end(), size_t(0));
+        for (size_t i = 0; i < k;) {
+            const size_t m = HWY_MIN(size_t(256), k - i);
+            draw(r, m, n - 1 - i);
+            for (size_t j = 0; j < m; ++j, ++i) {
+                std::swap(idx[i], idx[i + r[j]]);
+            }
+        }
+        idx.resize(k);
+        return idx;
+    }
+    // few of many: only the moved entries of [0, n) are kept
+    std::vector<size_t> out(k);
+    std::unordered_map<size_t, size_t> moved;
+    moved.reserve(2 * k);
+    for (size_t i = 0; i < k;) {
+        const size_t m = HWY_MIN(size_t(256), k - i);
+        draw(r, m, n - 1 - i);
+        for (size_t j = 0; j < m; ++j, ++i) {
+            const size_t at = i + r[j];
+            auto a          = moved.find(at);
+            auto b          = moved.find(i);
+            out[i]          = a == moved.end() ? at : a->second;
+            moved[at]       = b == moved.end() ? i : b->second;
+        }
+    }
+    return out;
+}
+
+// Scalar xoshiro256++ for seeding and jumps, rng::lanes is the vector version
+
+constexpr uint64_t kJump[]     = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa,
+                                  0x39abdc4529b1661c};
+constexpr uint64_t kLongJump[] = {0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241,
+                                  0x39109bb02acbe635};
+
+inline uint64_t splitmix64(uint64_t& x) {
+    uint64_t z = (x += 0x9e3779b97f4a7c15);
+    z          = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z          = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+inline void xoshiro_next(uint64_t* s) {
+    const uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = (s[3] << 45) | (s[3] >> 19);
+}
+
+/// s = poly(s), the jump polynomials of the xoshiro256 paper
+inline void xoshiro_jump(uint64_t* s, const uint64_t* poly) {
+    uint64_t r[4] = {0, 0, 0, 0};
+    for (int i = 0; i < 4; i++) {
+        for (int b = 0; b < 64; b++) {
+            if (poly[i] & ((uint64_t)1 << b)) {
+                for (int k = 0; k < 4; k++) {
+                    r[k] ^= s[k];
+                }
+            }
+            xoshiro_next(s);
+        }
+    }
+    for (int k = 0; k < 4; k++) {
+        s[k] = r[k];
+    }
 }
 
 }  // namespace
 
 namespace lc {
 
+bool constant_time_equal(const void* a, const void* b, size_t n) {
+    const hn::ScalableTag<uint8_t> d;
+    const size_t N   = hn::Lanes(d);
+    const uint8_t* x = (const uint8_t*)a;
+    const uint8_t* y = (const uint8_t*)b;
+    auto diff        = hn::Zero(d);
+    size_t i         = 0;
+    for (; i + N <= n; i += N) {
+        diff = hn::Or(diff, hn::Xor(hn::LoadU(d, x + i), hn::LoadU(d, y + i)));
+    }
+    if (i != n) {
+        diff = hn::Or(diff, hn::Xor(hn::LoadN(d, x + i, n - i), hn::LoadN(d, y + i, n - i)));
+    }
+    return hn::AllTrue(d, hn::Eq(diff, hn::Zero(d)));
+}
+
 double random() {
     return random_impl();
 }
@@ -70,4 +395,286 @@ size_t random(size_t m, size_t n) {
     return random_impl(m, n);
 }
 
+void random_bytes(void* buf, size_t n) {
+    fill_bytes(thread_generator<hn::VectorXoshiro>(), buf, n);
+}
+
+void random_fill(double* out, size_t n) {
+    fill_doubles(thread_generator<hn::VectorXoshiro>(), out, n);
+}
+
+void random_uniform_ints(int64_t* out, size_t n, int64_t lo, int64_t hi) {
+    fill_ints(thread_generator<hn::VectorXoshiro>(), thread_generator<hn::CachedXoshiro<>>(), out,
+              n, lo, hi);
+}
+
+void detail::shuffle_draws(uint64_t* out, size_t n, uint64_t top) {
+    fill_descending(thread_generator<hn::VectorXoshiro>(),
+                    thread_generator<hn::CachedXoshiro<>>(), out, n, top);
+}
+
+std::vector<size_t> sample_indices(size_t n, size_t k) {
+    return sample_indices_impl(
+        [](uint64_t* out, size_t m, uint64_t top) { detail::shuffle_draws(out, m, top); }, n, k);
+}
+
+uint64_t detail::thread_stream_id() {
+    return thread_stream::get().id;
+}
+
+uint64_t random_seed() {
+    uint64_t seed = 0;
+    try {
+        detail::os_entropy(&seed, sizeof(seed));
+    } catch (const std::runtime_error&) {
+        seed = ((uint64_t)time(nullptr) << 32) ^ (uint64_t)clock() ^ (uint64_t)(uintptr_t)&seed;
+    }
+    return seed;
+}
+
+void detail::os_entropy(void* buf, size_t n) {
+#if defined(_WIN32)
+    std::random_device rd;
+    for (size_t i = 0; i < n; i += 4) {
+        const unsigned int x = rd();
+        hwy::CopyBytes(&x, (char*)buf + i, HWY_MIN(n - i, 4));
+    }
+#elif defined(__linux__)
+    char* p = (char*)buf;
+    while (n != 0) {
+        const ssize_t k = getrandom(p, n, 0);
+        if (k < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("getrandom failed");
+        }
+        p += k;
+        n -= k;
+    }
+#else
+    arc4random_buf(buf, n);
+#endif
+}
+
+// rng
+
+/// Steps the 8 streams a vector at a time, operator() gives the next kLanes / N of them.
+/// The destructor finishes the round, every call on the rng starts with stream 0.
+struct rng::lanes {
+    using D = hn::CappedTag<uint64_t, kLanes>;
+
+    rng& r;
+    size_t k = 0;
+
+    explicit lanes(rng& g) : r(g) {}
+    ~lanes() {
+        while (k != 0) {
+            (*this)();
+        }
+    }
+
+    // xoshiro256++
+    hn::Vec<D> operator()() {
+        const D d;
+        auto s0       = hn::LoadU(d, r.state_[0] + k);
+        auto s1       = hn::LoadU(d, r.state_[1] + k);
+        auto s2       = hn::LoadU(d, r.state_[2] + k);
+        auto s3       = hn::LoadU(d, r.state_[3] + k);
+        const auto v  = hn::Add(hn::RotateRight<41>(hn::Add(s0, s3)), s0);
+        const auto t  = hn::ShiftLeft<17>(s1);
+        s2            = hn::Xor(s2, s0);
+        s3            = hn::Xor(s3, s1);
+        s1            = hn::Xor(s1, s2);
+        s0            = hn::Xor(s0, s3);
+        s2            = hn::Xor(s2, t);
+        s3            = hn::RotateRight<19>(s3);
+        hn::StoreU(s0, d, r.state_[0] + k);
+        hn::StoreU(s1, d, r.state_[1] + k);
+        hn::StoreU(s2, d, r.state_[2] + k);
+        hn::StoreU(s3, d, r.state_[3] + k);
+        k = (k + hn::Lanes(d)) % kLanes;
+        return v;
+    }
+};
+
+rng::rng() : rng(random_seed()) {}
+
+rng::rng(uint64_t seed, uint64_t stream) : pos_(kLanes) {
+    uint64_t s[4];
+    for (auto& x : s) {
+        x = splitmix64(seed);
+    }
+    for (uint64_t i = 0; i < stream; ++i) {
+        xoshiro_jump(s, kLongJump);
+    }
+    for (size_t j = 0; j < kLanes; ++j) {
+        for (size_t i = 0; i < 4; ++i) {
+            state_[i][j] = s[i];
+        }
+        xoshiro_jump(s, kJump);
+    }
+}
+
+void rng::refill() {
+    lanes g(*this);
+    const lanes::D d;
+    for (size_t i = 0; i < kLanes; i += hn::Lanes(d)) {
+        hn::StoreU(g(), d, cache_ + i);
+    }
+    pos_ = 0;
+}
+
+double rng::uniform() {
+    return (double)((*this)() >> 11) * 0x1.0p-53;
+}
+
+int64_t rng::uniform(int64_t lo, int64_t hi) {
+    if (HWY_UNLIKELY(lo > hi)) {
+        throw std::invalid_argument("rng::uniform: lo > hi");
+    }
+    const uint64_t range = (uint64_t)hi - (uint64_t)lo + 1;
+    return (int64_t)((uint64_t)lo + (range ? bounded((*this)(), range, *this) : (*this)()));
+}
+
+void rng::jump() {
+    // by kLanes streams, the lanes are a jump apart
+    jump_lanes(kJump, kLanes);
+}
+
+void rng::long_jump() {
+    jump_lanes(kLongJump, 1);
+}
+
+void rng::jump_lanes(const uint64_t* poly, size_t times) {
+    for (size_t j = 0; j < kLanes; ++j) {
+        uint64_t s[4] = {state_[0][j], state_[1][j], state_[2][j], state_[3][j]};
+        for (size_t n = 0; n < times; ++n) {
+            xoshiro_jump(s, poly);
+        }
+        for (size_t i = 0; i < 4; ++i) {
+            state_[i][j] = s[i];
+        }
+    }
+    pos_ = kLanes;
+}
+
+void rng::bytes(void* buf, size_t n) {
+    lanes g(*this);
+    fill_bytes(g, buf, n);
+}
+
+void rng::fill(double* out, size_t n) {
+    lanes g(*this);
+    fill_doubles(g, out, n);
+}
+
+void rng::uniform_ints(int64_t* out, size_t n, int64_t lo, int64_t hi) {
+    lanes g(*this);
+    fill_ints(g, *this, out, n, lo, hi);
+}
+
+void detail::shuffle_draws(rng& g, uint64_t* out, size_t n, uint64_t top) {
+    rng::lanes lg(g);
+    fill_descending(lg, g, out, n, top);
+}
+
+std::vector<size_t> sample_indices(rng& g, size_t n, size_t k) {
+    return sample_indices_impl(
+        [&g](uint64_t* out, size_t m, uint64_t top) { detail::shuffle_draws(g, out, m, top); },
+        n, k);
+}
+
+// weighted_choice
+
+weighted_choice::weighted_choice(const double* w, size_t n) : prob_(n), alias_(n) {
+    if (HWY_UNLIKELY(n == 0 || n > UINT32_MAX)) {
+        throw std::invalid_argument("weighted_choice: bad number of weights");
+    }
+    double sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (HWY_UNLIKELY(!(w[i] >= 0) || !std::isfinite(w[i]))) {
+            throw std::invalid_argument("weighted_choice: bad weight");
+        }
+        sum += w[i];
+    }
+    if (HWY_UNLIKELY(!(sum > 0) || !std::isfinite(sum))) {
+        throw std::invalid_argument("weighted_choice: bad sum of weights");
+    }
+
+    // Vose: every column under the mean is topped up by one over it
+    std::vector<double> q(n);
+    std::vector<uint32_t> small, large;
+    for (size_t i = 0; i < n; ++i) {
+        q[i] = w[i] * (double)n / sum;
+        (q[i] < 1 ? small : large).push_back((uint32_t)i);
+    }
+    while (!small.empty() && !large.empty()) {
+        const uint32_t s = small.back();
+        const uint32_t l = large.back();
+        small.pop_back();
+        prob_[s]  = (uint32_t)HWY_MIN(q[s] * 0x1.0p32, (double)UINT32_MAX);
+        alias_[s] = l;
+        q[l]      = (q[l] + q[s]) - 1;
+        if (q[l] < 1) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // full columns, and whatever rounding left over
+    for (auto* rest : {&small, &large}) {
+        for (uint32_t i : *rest) {
+            prob_[i]  = UINT32_MAX;
+            alias_[i] = i;
+        }
+    }
+}
+
+void weighted_choice::select(size_t* out, const int64_t* col, const uint32_t* coin,
+                             size_t n) const {
+    for (size_t i = 0; i < n; ++i) {
+        const size_t c = (size_t)col[i];
+        out[i]         = coin[i] < prob_[c] ? c : alias_[c];
+    }
+}
+
+size_t weighted_choice::operator()() const {
+    auto& g           = thread_generator<hn::CachedXoshiro<>>();
+    const int64_t col   = (int64_t)bounded(g(), size(), g);
+    const uint32_t coin = (uint32_t)g();
+    size_t out;
+    select(&out, &col, &coin, 1);
+    return out;
+}
+
+size_t weighted_choice::operator()(rng& g) const {
+    const int64_t col   = (int64_t)bounded(g(), size(), g);
+    const uint32_t coin = (uint32_t)g();
+    size_t out;
+    select(&out, &col, &coin, 1);
+    return out;
+}
+
+void weighted_choice::operator()(size_t* out, size_t count) const {
+    int64_t col[256];
+    uint32_t coin[256];
+    for (size_t i = 0; i < count; i += 256) {
+        const size_t m = HWY_MIN(size_t(256), count - i);
+        random_uniform_ints(col, m, 0, (int64_t)size() - 1);
+        random_bytes(coin, m * sizeof(uint32_t));
+        select(out + i, col, coin, m);
+    }
+}
+
+void weighted_choice::operator()(rng& g, size_t* out, size_t count) const {
+    int64_t col[256];
+    uint32_t coin[256];
+    for (size_t i = 0; i < count; i += 256) {
+        const size_t m = HWY_MIN(size_t(256), count - i);
+        g.uniform_ints(col, m, 0, (int64_t)size() - 1);
+        g.bytes(coin, m * sizeof(uint32_t));
+        select(out + i, col, coin, m);
+    }
+}
+
 }  // namespace lc
@@ -1,4 +1,5 @@
 #include "lcrypt/base64.h"
+#include "detail/base64.h"
 #include "detail/hwy.h"
 #include <stdexcept>
 #include <string>
@@ -16,6 +17,7 @@ static inline size_t base64_padding_count(const char* buf, size_t len) {
 
 struct EncodeUnit : hn::UnrollerUnit<EncodeUnit, u8, u8> {
     using D = hn::ScalableTag<u8>;
+    const bool _url; /* '-' and '_' for 62 and 63 */
     const vu8 _0x0fc0fc00                  = hn::BitCast(_du8, hn::Set(_du32, 0x0fc0fc00));
     const vu16 _0x04000040 = hn::BitCast(_du16, hn::Set(_du32, 0x04000040));
     const vu8 _0x003f03f0                  = hn::BitCast(_du8, hn::Set(_du32, 0x003f03f0));
@@ -29,16 +31,18 @@ struct EncodeUnit : hn::UnrollerUnit<EncodeUnit, u8, u8> {
     HWY_ALIGN static constexpr uint8_t _encode_shuf_buf[] = {
         5,  4,  6,  5,  8,  7,  9,  8,  11, 10, 12, 11, 14, 13, 15, 14,  //
         17, 16, 18, 17, 20, 19, 21, 20, 23, 22, 24, 23, 26, 25, 27, 26,  //
-        37, 36, 38, 37, 40, 39, 41, 40, 43, 42, 44, 33, 46, 45, 47, 46,  //
+        37, 36, 38, 37, 40, 39, 41, 40, 43, 42, 44, 43, 46, 45, 47, 46,  //
         49, 48, 50, 49, 52, 51, 53, 52, 55, 54, 56, 55, 58, 57, 59, 58,  //
     };
     const vu8 _encode_indices = hn::LoadU(_du8, _encode_shuf_buf);
     const vu8 _encode_lut =
         hn::Dup128VecFromValues(_du8, 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
-                                '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
-                                '/' - 63, 'A', 0, 0);
+                                '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                (_url ? '-' : '+') - 62, (_url ? '_' : '/') - 63, 'A', 0, 0);
     // clang-format on
 
+    explicit EncodeUnit(bool url = false) : _url(url) {}
+
     hn::Vec<D> Func(ptrdiff_t, const hn::Vec<D> xx, const hn::Vec<D>) {
         // refer:
         // https://github.com/WojciechMula/base64simd/blob/master/encode/encode.sse.cpp
@@ -67,8 +71,9 @@ struct EncodeUnit : hn::UnrollerUnit<EncodeUnit, u8, u8> {
         /// indexof(src):indexof(dest) => 3:4
         ptrdiff_t j = idx * 3 / 4;
         if constexpr (multiple == 4) {
-            auto p1 = hn::LoadN(_du8, from + j - 4, count + 4);
-            auto p2 = hn::LoadN(_du8, from + j + count - 4, count + 4);
+            // two 256-bit halves, each laid out like the AVX2 load
+            auto p1 = hn::LoadN(_du8, from + j - 4, 32);
+            auto p2 = hn::LoadN(_du8, from + j + count / 2 - 4, 32);
             return hn::Add(p1, hn::SlideUpLanes(_du8, p2, 32));
         } else if constexpr (multiple == 2 || multiple == 1) {
             return hn::LoadU(_du8, from + j - 4);
@@ -240,19 +245,23 @@ struct DecodeUnit : hn::UnrollerUnit<DecodeUnit, u8, u8> {
 
 namespace lc {
 
-std::string base64_encode(const char* in, size_t len) {
-    EncodeUnit unit;
+void detail::base64_encode_to(const char* in, size_t len, char* out, bool url) {
+    EncodeUnit unit(url);
     const size_t mod = len % 3;
     size_t olen      = base64_encode_size(in, len);
-    std::string result(olen, '\0');
-    hn::Unroller(unit, (u8*)(const_cast<char*>(in)), (u8*)result.data(), olen);
+    hn::Unroller(unit, (u8*)(const_cast<char*>(in)), (u8*)out, olen);
     if (mod > 0) {
         // padding
         int pad = 3 - mod;
         for (int i = 0, j = olen - 1; i < pad; ++i, --j) {
-            result[j] = '=';
+            out[j] = '=';
         }
     }
+}
+
+std::string base64_encode(const char* in, size_t len) {
+    std::string result(base64_encode_size(in, len), '\0');
+    detail::base64_encode_to(in, len, result.data(), false);
     return result;
 }
 
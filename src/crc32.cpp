@@ -0,0 +1,226 @@
+#include "lcrypt/crc32.h"
+#include "detail/hwy.h"
+#include "detail/multibuffer.h"
+#include <string.h>
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+namespace {
+
+/// The tables and folding constants of a reflected CRC-32
+struct crc_consts {
+    uint32_t table[8][256];            /* slicing by 8 */
+    HWY_ALIGN uint64_t fold_4v[2];     /* 4 vectors ahead */
+    HWY_ALIGN uint64_t fold_v[2];      /* a vector ahead */
+    HWY_ALIGN uint64_t fold_16[2];     /* 16 bytes ahead */
+    uint32_t x2n[32];                  /* x^(2^k) mod P, reflected */
+    uint32_t rpoly;
+
+    crc_consts(uint32_t poly, uint32_t reflected) : rpoly(reflected) {
+        for (uint32_t b = 0; b < 256; ++b) {
+            uint32_t r = b;
+            for (int k = 0; k < 8; ++k) {
+                r = r & 1 ? (r >> 1) ^ reflected : r >> 1;
+            }
+            table[0][b] = r;
+        }
+        for (int t = 1; t < 8; ++t) {
+            for (uint32_t b = 0; b < 256; ++b) {
+                table[t][b] = (table[t - 1][b] >> 8) ^ table[0][table[t - 1][b] & 0xff];
+            }
+        }
+        const size_t N8 = hn::Lanes(hn::ScalableTag<uint8_t>());
+        distance(fold_4v, poly, 4 * N8 * 8);
+        distance(fold_v, poly, N8 * 8);
+        distance(fold_16, poly, 128);
+        x2n[0] = 1u << 30; /* x^1 */
+        for (int k = 1; k < 32; ++k) {
+            x2n[k] = multmodp(x2n[k - 1], x2n[k - 1]);
+        }
+    }
+
+    /// x^n mod P, bit m is x^m
+    static uint32_t xpow(uint64_t n, uint32_t poly) {
+        uint32_t r = 1;
+        for (; n != 0; --n) {
+            r = r & 0x80000000u ? (r << 1) ^ poly : r << 1;
+        }
+        return r;
+    }
+
+    static uint64_t reverse64(uint64_t x) {
+        uint64_t r = 0;
+        for (int i = 0; i < 64; ++i, x >>= 1) {
+            r = (r << 1) | (x & 1);
+        }
+        return r;
+    }
+
+    /// A 128 bit block is the polynomial of degree < 128 with bit i as x^(127 - i). Moving it
+    /// `bits` ahead multiplies its low half by x^(bits + 64) and its high half by x^bits. A
+    /// carry-less multiply of two such halves gives x * a * b, hence the one less.
+    static void distance(uint64_t* k, uint32_t poly, uint64_t bits) {
+        k[0] = reverse64(xpow(bits + 63, poly));
+        k[1] = reverse64(xpow(bits - 1, poly));
+    }
+
+    /// a * b mod P, reflected
+    uint32_t multmodp(uint32_t a, uint32_t b) const {
+        uint32_t m = 1u << 31, p = 0;
+        for (;;) {
+            if (a & m) {
+                p ^= b;
+                if ((a & (m - 1)) == 0) {
+                    break;
+                }
+            }
+            m >>= 1;
+            b = b & 1 ? (b >> 1) ^ rpoly : b >> 1;
+        }
+        return p;
+    }
+
+    /// CRC(A || B) from CRC(A), CRC(B) and |B|, the same as zlib
+    uint32_t combine(uint32_t a, uint32_t b, uint64_t len_b) const {
+        uint32_t p = 1u << 31; /* x^0 */
+        for (int k = 3; len_b != 0; len_b >>= 1, ++k) {
+            if (len_b & 1) {
+                p = multmodp(x2n[k & 31], p);
+            }
+        }
+        return multmodp(p, a) ^ b;
+    }
+};
+
+const crc_consts kCrc32c(0x1edc6f41, 0x82f63b78);
+const crc_consts kCrc32(0x04c11db7, 0xedb88320);
+
+using lc::detail::load_le64;
+
+/// The CRC register over `len` bytes, no inversions
+uint32_t slice8(const crc_consts& c, uint32_t reg, const uint8_t* p, size_t len) {
+    const auto& t = c.table;
+    for (; len >= 8; len -= 8, p += 8) {
+        const uint64_t v = load_le64(p) ^ reg;
+        reg = t[7][v & 0xff] ^ t[6][(v >> 8) & 0xff] ^ t[5][(v >> 16) & 0xff] ^
+              t[4][(v >> 24) & 0xff] ^ t[3][(v >> 32) & 0xff] ^ t[2][(v >> 40) & 0xff] ^
+              t[1][(v >> 48) & 0xff] ^ t[0][v >> 56];
+    }
+    for (; len != 0; --len, ++p) {
+        reg = (reg >> 8) ^ t[0][(reg ^ *p) & 0xff];
+    }
+    return reg;
+}
+
+uint32_t crc32c_short(uint32_t reg, const uint8_t* p, size_t len) {
+#if defined(__SSE4_2__)
+    uint64_t r = reg;
+    for (; len >= 8; len -= 8, p += 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        r = _mm_crc32_u64(r, v);
+    }
+    reg = (uint32_t)r;
+    for (; len != 0; --len, ++p) {
+        reg = _mm_crc32_u8(reg, *p);
+    }
+    return reg;
+#else
+    return slice8(kCrc32c, reg, p, len);
+#endif
+}
+
+uint32_t crc32_short(uint32_t reg, const uint8_t* p, size_t len) {
+    return slice8(kCrc32, reg, p, len);
+}
+
+template <class V>
+HWY_INLINE V fold(V x, V k) {
+    return hn::Xor(hn::CLMulLower(x, k), hn::CLMulUpper(x, k));
+}
+
+/// Carry-less multiply folding over four vectors of independent 128 bit streams, every
+/// stream moved 4 vectors ahead a step. The streams are then folded into one 128 bit block,
+/// whose CRC `tail` finishes before the last bytes. `len` >= 4 vectors.
+template <typename Tail>
+uint32_t fold_crc(const crc_consts& c, uint32_t reg, const uint8_t* p, size_t len, Tail&& tail) {
+    using D = hn::ScalableTag<uint64_t>;
+    const D d;
+    const hn::Repartition<uint8_t, D> d8;
+    const hn::FixedTag<uint64_t, 2> d2;
+    const size_t N8 = hn::Lanes(d8);
+    const auto load = [&](const uint8_t* q) { return hn::BitCast(d, hn::LoadU(d8, q)); };
+
+    HWY_ALIGN uint64_t buf[hn::MaxLanes(d)] = {0};
+    buf[0]                                  = reg;
+    auto x0 = hn::Xor(load(p), hn::Load(d, buf));
+    auto x1 = load(p + N8);
+    auto x2 = load(p + 2 * N8);
+    auto x3 = load(p + 3 * N8);
+    p += 4 * N8;
+    len -= 4 * N8;
+
+    const auto k4 = hn::LoadDup128(d, c.fold_4v);
+    for (; len >= 4 * N8; len -= 4 * N8, p += 4 * N8) {
+        x0 = hn::Xor(fold(x0, k4), load(p));
+        x1 = hn::Xor(fold(x1, k4), load(p + N8));
+        x2 = hn::Xor(fold(x2, k4), load(p + 2 * N8));
+        x3 = hn::Xor(fold(x3, k4), load(p + 3 * N8));
+    }
+    const auto k1 = hn::LoadDup128(d, c.fold_v);
+    x1            = hn::Xor(fold(x0, k1), x1);
+    x2            = hn::Xor(fold(x1, k1), x2);
+    x3            = hn::Xor(fold(x2, k1), x3);
+    for (; len >= N8; len -= N8, p += N8) {
+        x3 = hn::Xor(fold(x3, k1), load(p));
+    }
+
+    // the 128 bit blocks of the vector, then the last whole blocks
+    const auto k16 = hn::LoadDup128(d2, c.fold_16);
+    hn::Store(x3, d, buf);
+    auto r = hn::Load(d2, buf);
+    for (size_t b = 2; b < N8 / 8; b += 2) {
+        r = hn::Xor(fold(r, k16), hn::Load(d2, buf + b));
+    }
+    for (; len >= 16; len -= 16, p += 16) {
+        r = hn::Xor(fold(r, k16), hn::BitCast(d2, hn::LoadU(hn::FixedTag<uint8_t, 16>(), p)));
+    }
+    uint8_t last[16];
+    hn::StoreU(hn::BitCast(hn::FixedTag<uint8_t, 16>(), r), hn::FixedTag<uint8_t, 16>(), last);
+    return tail(tail(0, last, 16), p, len);
+}
+
+template <typename Tail>
+uint32_t crc(const crc_consts& c, uint32_t crc, const void* data, size_t len, Tail&& tail) {
+    const uint8_t* p = (const uint8_t*)data;
+    uint32_t reg     = ~crc;
+#if !defined(LC_IS_BIG_ENDIAN)
+    if (len >= 4 * hn::Lanes(hn::ScalableTag<uint8_t>())) {
+        return ~fold_crc(c, reg, p, len, tail);
+    }
+#endif
+    return ~tail(reg, p, len);
+}
+
+}  // namespace
+
+namespace lc {
+
+uint32_t crc32c(const void* data, size_t len, uint32_t crc) {
+    return ::crc(kCrc32c, crc, data, len, crc32c_short);
+}
+
+uint32_t crc32(const void* data, size_t len, uint32_t crc) {
+    return ::crc(kCrc32, crc, data, len, crc32_short);
+}
+
+uint32_t crc32c_combine(uint32_t crc_a, uint32_t crc_b, uint64_t len_b) {
+    return kCrc32c.combine(crc_a, crc_b, len_b);
+}
+
+uint32_t crc32_combine(uint32_t crc_a, uint32_t crc_b, uint64_t len_b) {
+    return kCrc32.combine(crc_a, crc_b, len_b);
+}
+
+}  // namespace lc
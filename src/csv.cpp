@@ -0,0 +1,150 @@
+#include "lcrypt/csv.h"
+#include "detail/hwy.h"
+#include <string.h>
+
+namespace {
+
+/// bit i = xor of bits [0, i], turns quote positions into an "inside quotes" mask
+inline uint64_t prefix_xor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+inline size_t popcount(uint64_t x) {
+    return hwy::PopCount(x);
+}
+
+}  // namespace
+
+namespace lc {
+
+void csv_reader::load_block() {
+    const u8* p      = (const u8*)data_.data();
+    const size_t len = data_.size();
+    const vu8 delim  = hn::Set(_du8, (u8)delim_);
+    const vu8 quote  = hn::Set(_du8, (u8)quote_);
+    const vu8 lf     = hn::Set(_du8, '\n');
+
+    uint64_t q = 0, d = 0, nl = 0;
+    for (size_t k = 0; k < 64 && next_ + k < len; k += N8) {
+        const size_t n   = HWY_MIN(N8, len - next_ - k);
+        const auto valid = hn::FirstN(_du8, n);
+        const auto x     = hn::LoadN(_du8, p + next_ + k, n);
+        q |= MaskBits(_du8, hn::And(hn::Eq(x, quote), valid)) << k;
+        d |= MaskBits(_du8, hn::And(hn::Eq(x, delim), valid)) << k;
+        nl |= MaskBits(_du8, hn::And(hn::Eq(x, lf), valid)) << k;
+    }
+
+    const uint64_t inside = prefix_xor(q) ^ inquote_;
+    inquote_              = (uint64_t)((int64_t)inside >> 63);
+    quotes_               = q;
+    eols_                 = nl & ~inside;
+    seps_                 = (d | nl) & ~inside;
+    block_                = next_;
+    next_ += 64;
+}
+
+void csv_reader::push_field(std::vector<std::string_view>& fields, size_t end, bool eol) {
+    const char* p = data_.data() + start_;
+    size_t n      = end - start_;
+    if (eol && n > 0 && p[n - 1] == '\r') {
+        --n;
+    }
+    const size_t nquotes = nquotes_;
+    nquotes_             = 0;
+    if (n < 2 || p[0] != quote_ || p[n - 1] != quote_) {
+        fields.emplace_back(p, n);
+        return;
+    }
+    ++p;
+    n -= 2;
+    if (nquotes == 2) {
+        fields.emplace_back(p, n);
+        return;
+    }
+
+    // doubled quotes, the view is fixed up once the record is complete
+    const size_t old = buf_.size();
+    buf_.resize(old + n);
+    char* out = buf_.data() + old;
+    size_t j  = 0;
+    for (;;) {
+        const char* q = (const char*)memchr(p, quote_, n);
+        if (!q) {
+            hwy::CopyBytes(p, out + j, n);
+            j += n;
+            break;
+        }
+        const size_t m = q - p + 1;  // keep one quote
+        hwy::CopyBytes(p, out + j, m);
+        j += m;
+        // skip its twin
+        const size_t skip = m < n && p[m] == quote_ ? m + 1 : m;
+        p += skip;
+        n -= skip;
+    }
+    buf_.resize(old + j);
+    unescaped_.emplace_back(fields.size(), old);
+    fields.emplace_back(data_.data(), j);
+}
+
+bool csv_reader::next(std::vector<std::string_view>& fields) {
+    const size_t len = data_.size();
+    fields.clear();
+    buf_.clear();
+    unescaped_.clear();
+
+    auto finish = [&] {
+        for (const auto& [idx, ofs] : unescaped_) {
+            fields[idx] = std::string_view(buf_.data() + ofs, fields[idx].size());
+        }
+        return true;
+    };
+
+    for (;;) {
+        while (seps_ == 0) {
+            nquotes_ += popcount(quotes_);
+            quotes_ = 0;
+            if (next_ >= len) {
+                if (HWY_UNLIKELY(inquote_)) {
+                    throw input_error(start_, quote_);
+                }
+                if (fields.empty() && (start_ >= len || (start_ + 1 == len && data_[start_] == '\r'))) {
+                    start_ = len;
+                    return false;
+                }
+                push_field(fields, len, true);
+                start_ = len;
+                return finish();
+            }
+            load_block();
+        }
+
+        const size_t b       = hwy::Num0BitsBelowLS1Bit_Nonzero64(seps_);
+        const uint64_t below = (uint64_t(1) << b) - 1;
+        const size_t end     = block_ + b;
+        seps_ &= seps_ - 1;
+        nquotes_ += popcount(quotes_ & below);
+        quotes_ &= ~below;
+
+        if ((eols_ >> b) & 1) {
+            if (fields.empty() && (end == start_ || (end == start_ + 1 && data_[start_] == '\r'))) {
+                // blank line
+                start_ = end + 1;
+                continue;
+            }
+            push_field(fields, end, true);
+            start_ = end + 1;
+            return finish();
+        }
+        push_field(fields, end, false);
+        start_ = end + 1;
+    }
+}
+
+}  // namespace lc
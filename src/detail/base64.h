@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stddef.h>
+
+namespace lc {
+namespace detail {
+
+/// base64_encode into `out`, base64_encode_size() bytes. `url` uses the RFC 4648 url-safe
+/// alphabet. Reads up to 4 bytes before `in` and a vector past its end.
+void base64_encode_to(const char* in, size_t len, char* out, bool url);
+
+}  // namespace detail
+}  // namespace lc
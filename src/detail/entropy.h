@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stddef.h>
+
+namespace lc {
+namespace detail {
+
+/// Fills `buf` from the OS CSPRNG, throws std::runtime_error if it is unavailable
+void os_entropy(void* buf, size_t n);
+
+/// memset(0) the compiler cannot drop, for key material
+inline void secure_zero(void* buf, size_t n) {
+    volatile unsigned char* p = (volatile unsigned char*)buf;
+    while (n--) {
+        *p++ = 0;
+    }
+}
+
+}  // namespace detail
+}  // namespace lc
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "hwy.h"
+#include <stdint.h>
+
+namespace lc {
+namespace detail {
+
+/// hex_encode into `out`, 2 * len bytes
+void hex_encode_to(const char* in, size_t len, char* out);
+
+/// '0'-'9', 'a'-'f', 'A'-'F' => 0-15, otherwise 0xff
+inline uint8_t hex_nibble(uint8_t c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c |= 0x20;  // tolower
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return 0xff;
+}
+
+/// Vector version of `hex_nibble`
+struct HexNibbleLut {
+    // clang-format off
+    const vu8 _hex_lut = hn::Dup128VecFromValues(_du8,
+        /* 0 */ 0x00,        /* 1 */ 0x00,        /* 2 */ 0x00,        /* 3 */ 0x00 - 0x30,
+        /* 4 */ 0x0A - 0x41, /* 5 */ 0x00,        /* 6 */ 0x0A - 0x61, /* 7 */ 0x00,
+        /* 8 */ 0x00,        /* 9 */ 0x00,        /* a */ 0x00,        /* b */ 0x00,
+        /* c */ 0x00,        /* d */ 0x00,        /* e */ 0x00,        /* f */ 0x00);
+    const vu8 _lower_lut = hn::Dup128VecFromValues(_du8,
+        /* 0 */ 0xff, /* 1 */ 0xff, /* 2 */ 0xff, /* 3 */ 0x30,
+        /* 4 */ 0x41, /* 5 */ 0xff, /* 6 */ 0x61, /* 7 */ 0xff,
+        /* 8 */ 0xff, /* 9 */ 0xff, /* a */ 0xff, /* b */ 0xff,
+        /* c */ 0xff, /* d */ 0xff, /* e */ 0xff, /* f */ 0xff);
+    const vu8 _upper_lut = hn::Dup128VecFromValues(_du8,
+        /* 0 */ 0x00, /* 1 */ 0x00, /* 2 */ 0x00, /* 3 */ 0x39,
+        /* 4 */ 0x46, /* 5 */ 0x00, /* 6 */ 0x66, /* 7 */ 0x00,
+        /* 8 */ 0x00, /* 9 */ 0x00, /* a */ 0x00, /* b */ 0x00,
+        /* c */ 0x00, /* d */ 0x00, /* e */ 0x00, /* f */ 0x00);
+    // clang-format on
+
+    /// nibble values, only meaningful for lanes in `Valid()`
+    vu8 Decode(const vu8 x) const {
+        const auto higher_nibble = hn::ShiftRight<4>(x);
+        return hn::Add(x, hn::TableLookupBytes(_hex_lut, higher_nibble));
+    }
+
+    hn::Mask<HWY_FULL(u8)> Valid(const vu8 x) const {
+        const auto higher_nibble = hn::ShiftRight<4>(x);
+        const auto lower         = hn::TableLookupBytes(_lower_lut, higher_nibble);
+        const auto upper         = hn::TableLookupBytes(_upper_lut, higher_nibble);
+        return hn::And(hn::Ge(x, lower), hn::Le(x, upper));
+    }
+};
+
+}  // namespace detail
+}  // namespace lc
@@ -68,6 +68,18 @@ V IfThenElse(const V mask, const V yes, const V no) {
     return hn::Or(y, n);
 }
 
+/// bit i set <=> lane i of `m` is true, requires Lanes(d) <= 64
+template <typename D>
+uint64_t MaskBits(D d, const hn::Mask<D> m) {
+    uint8_t buf[8] = {0};
+    hn::StoreMaskBits(d, m, buf);
+    uint64_t bits = 0;
+    for (int i = 7; i >= 0; --i) {
+        bits = (bits << 8) | buf[i];
+    }
+    return bits;
+}
+
 template <typename V>
 V IfThenElseZero(const V mask, const V yes) {
     return hn::And(mask, yes);
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "hwy.h"
+#include <string_view>
+#include <stdint.h>
+#include <string.h>
+
+namespace lc {
+namespace detail {
+
+inline uint32_t load_be32(const uint8_t* p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+inline uint32_t load_le32(const uint8_t* p) {
+    return (uint32_t)p[3] << 24 | (uint32_t)p[2] << 16 | (uint32_t)p[1] << 8 | p[0];
+}
+
+inline uint64_t load_le64(const uint8_t* p) {
+    return (uint64_t)load_le32(p + 4) << 32 | load_le32(p);
+}
+
+inline void store_be32(uint8_t* p, uint32_t x) {
+    p[0] = (uint8_t)(x >> 24);
+    p[1] = (uint8_t)(x >> 16);
+    p[2] = (uint8_t)(x >> 8);
+    p[3] = (uint8_t)x;
+}
+
+inline void store_le32(uint8_t* p, uint32_t x) {
+    p[0] = (uint8_t)x;
+    p[1] = (uint8_t)(x >> 8);
+    p[2] = (uint8_t)(x >> 16);
+    p[3] = (uint8_t)(x >> 24);
+}
+
+/// Merkle-Damgard padding of the last `len % 64` bytes of a `len` byte message plus
+/// `prefix` bytes hashed before it: 0x80, zeros and the bit length. Returns 1 or 2 blocks.
+inline size_t md_pad(uint8_t* tail, const uint8_t* rest, size_t len, uint64_t prefix,
+                     bool big_endian) {
+    const size_t r = len % 64;
+    const size_t n = r + 9 <= 64 ? 1 : 2;
+    if (r != 0) {
+        memcpy(tail, rest, r);
+    }
+    tail[r] = 0x80;
+    memset(tail + r + 1, 0, n * 64 - r - 1);
+    const uint64_t bits = (prefix + len) * 8;
+    uint8_t* p          = tail + n * 64 - 8;
+    for (int i = 0; i < 8; ++i) {
+        p[big_endian ? 7 - i : i] = (uint8_t)(bits >> (8 * i));
+    }
+    return n;
+}
+
+/// The buffering of a streaming update(): `buf` holds the partial block of the `total` bytes
+/// seen so far, `compress(p, blocks)` takes whole 64 byte blocks.
+template <typename F>
+void md_update(uint8_t* buf, uint64_t& total, const uint8_t* p, size_t len, F&& compress) {
+    const size_t used = total % 64;
+    total += len;
+    if (len == 0) {
+        return;
+    }
+    if (used != 0) {
+        const size_t n = HWY_MIN(len, 64 - used);
+        memcpy(buf + used, p, n);
+        p += n;
+        len -= n;
+        if (used + n < 64) {
+            return;
+        }
+        compress(buf, 1);
+    }
+    if (len >= 64) {
+        compress(p, len / 64);
+    }
+    if (len % 64 != 0) {
+        memcpy(buf, p + len / 64 * 64, len % 64);
+    }
+}
+
+/// Hashes `n` messages a u32 lane each and stores the digests in out[i].data(). A lane takes
+/// the next message as soon as its own is done, so mixed lengths keep the lanes busy.
+/// `H` has kWords, kDigestSize, kBigEndian, and
+///   static void compress(D d, hn::Vec<D>* state, const hn::Vec<D>* w) over 16 words.
+/// `iv` is the state every message starts from, after `prefix` bytes already hashed (HMAC).
+template <typename H, typename Out>
+void hash_lanes(const std::string_view* msgs, size_t n, Out* out, const uint32_t* iv,
+                uint64_t prefix = 0) {
+    using D = hn::ScalableTag<uint32_t>;
+    const D d;
+    const size_t N            = hn::Lanes(d);
+    constexpr size_t kMaxLane = hn::MaxLanes(D());
+    constexpr size_t W        = H::kWords;
+
+    struct job {
+        const uint8_t* data;
+        size_t full, blocks, at, msg;
+        bool live;
+        uint8_t tail[128];
+    };
+    static const uint8_t zero[64] = {0};
+    job jobs[kMaxLane];
+    HWY_ALIGN uint32_t st[W][kMaxLane];
+    HWY_ALIGN uint32_t w[16][kMaxLane];
+    size_t next = 0, busy = 0;
+
+    const auto start = [&](size_t l) {
+        job& j = jobs[l];
+        j.live = next != n;
+        if (!j.live) {
+            return;
+        }
+        const std::string_view m = msgs[next];
+        j.data                   = (const uint8_t*)m.data();
+        j.full                   = m.size() / 64;
+        j.blocks = j.full + md_pad(j.tail, j.data + j.full * 64, m.size(), prefix, H::kBigEndian);
+        j.at     = 0;
+        j.msg    = next++;
+        for (size_t k = 0; k < W; ++k) {
+            st[k][l] = iv[k];
+        }
+        ++busy;
+    };
+    for (size_t l = 0; l < N; ++l) {
+        start(l);
+    }
+
+    hn::Vec<D> vs[W], vw[16];
+    while (busy != 0) {
+        for (size_t l = 0; l < N; ++l) {
+            const job& j     = jobs[l];
+            const uint8_t* p = !j.live         ? zero
+                               : j.at < j.full ? j.data + j.at * 64
+                                               : j.tail + (j.at - j.full) * 64;
+            for (size_t k = 0; k < 16; ++k) {
+                w[k][l] = H::kBigEndian ? load_be32(p + 4 * k) : load_le32(p + 4 * k);
+            }
+        }
+        for (size_t k = 0; k < W; ++k) {
+            vs[k] = hn::Load(d, st[k]);
+        }
+        for (size_t k = 0; k < 16; ++k) {
+            vw[k] = hn::Load(d, w[k]);
+        }
+        H::compress(d, vs, vw);
+        for (size_t k = 0; k < W; ++k) {
+            hn::Store(vs[k], d, st[k]);
+        }
+        for (size_t l = 0; l < N; ++l) {
+            job& j = jobs[l];
+            if (j.live && ++j.at == j.blocks) {
+                uint8_t* o = out[j.msg].data();
+                for (size_t k = 0; k < H::kDigestSize / 4; ++k) {
+                    H::kBigEndian ? store_be32(o + 4 * k, st[k][l]) : store_le32(o + 4 * k, st[k][l]);
+                }
+                --busy;
+                start(l);
+            }
+        }
+    }
+}
+
+}  // namespace detail
+}  // namespace lc
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string_view>
+#include <lcrypt/sha256.h>
+#include <stdint.h>
+
+namespace lc {
+namespace detail {
+
+/// sha256_batch with every message resumed from the chaining value `iv` after `prefix` bytes
+void sha256_batch(const std::string_view* msgs, size_t n, sha256::digest_t* out,
+                  const uint32_t* iv, uint64_t prefix);
+
+/// `blocks` 64 byte blocks into the chaining value `h`
+void sha256_compress(uint32_t* h, const uint8_t* p, size_t blocks);
+
+}  // namespace detail
+}  // namespace lc
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace lc {
+namespace detail {
+
+/// Decodes one strict UTF-8 sequence, returns its length or 0 if invalid.
+inline int utf8_decode(const uint8_t* p, size_t n, uint32_t& cp) {
+    const uint8_t c = p[0];
+    if (c < 0x80) {
+        cp = c;
+        return 1;
+    } else if (c < 0xc2) {
+        return 0;
+    } else if (c < 0xe0) {
+        if (n < 2 || (p[1] & 0xc0) != 0x80) return 0;
+        cp = ((c & 0x1f) << 6) | (p[1] & 0x3f);
+        return 2;
+    } else if (c < 0xf0) {
+        if (n < 3 || (p[1] & 0xc0) != 0x80 || (p[2] & 0xc0) != 0x80) return 0;
+        cp = ((c & 0x0f) << 12) | ((p[1] & 0x3f) << 6) | (p[2] & 0x3f);
+        if (cp < 0x800 || (cp >= 0xd800 && cp <= 0xdfff)) return 0;
+        return 3;
+    } else if (c < 0xf5) {
+        if (n < 4 || (p[1] & 0xc0) != 0x80 || (p[2] & 0xc0) != 0x80 || (p[3] & 0xc0) != 0x80)
+            return 0;
+        cp = ((c & 0x07) << 18) | ((p[1] & 0x3f) << 12) | ((p[2] & 0x3f) << 6) | (p[3] & 0x3f);
+        if (cp < 0x10000 || cp > 0x10ffff) return 0;
+        return 4;
+    }
+    return 0;
+}
+
+/// Returns the number of bytes written to `out` (1..4).
+inline int utf8_encode(uint32_t cp, uint8_t* out) {
+    if (cp < 0x80) {
+        out[0] = (uint8_t)cp;
+        return 1;
+    } else if (cp < 0x800) {
+        out[0] = (uint8_t)(0xc0 | (cp >> 6));
+        out[1] = (uint8_t)(0x80 | (cp & 0x3f));
+        return 2;
+    } else if (cp < 0x10000) {
+        out[0] = (uint8_t)(0xe0 | (cp >> 12));
+        out[1] = (uint8_t)(0x80 | ((cp >> 6) & 0x3f));
+        out[2] = (uint8_t)(0x80 | (cp & 0x3f));
+        return 3;
+    } else {
+        out[0] = (uint8_t)(0xf0 | (cp >> 18));
+        out[1] = (uint8_t)(0x80 | ((cp >> 12) & 0x3f));
+        out[2] = (uint8_t)(0x80 | ((cp >> 6) & 0x3f));
+        out[3] = (uint8_t)(0x80 | (cp & 0x3f));
+        return 4;
+    }
+}
+
+}  // namespace detail
+}  // namespace lc
@@ -0,0 +1,468 @@
+#include "lcrypt/hash.h"
+#include "detail/hwy.h"
+#include "detail/multibuffer.h"
+#include <string.h>
+
+namespace {
+
+using lc::detail::load_le32;
+using lc::detail::load_le64;
+
+// XXH3
+
+constexpr uint32_t P32_1 = 0x9e3779b1, P32_2 = 0x85ebca77, P32_3 = 0xc2b2ae3d;
+constexpr uint64_t P64_1 = 0x9e3779b185ebca87, P64_2 = 0xc2b2ae3d27d4eb4f,
+                   P64_3 = 0x165667b19e3779f9, P64_4 = 0x85ebca77c2b2ae63,
+                   P64_5 = 0x27d4eb2f165667c5;
+
+constexpr size_t kSecretSize = 192;
+constexpr size_t kStripe     = 64;
+/// Stripes between two scrambles, the secret moves 8 bytes a stripe
+constexpr size_t kStripes = (kSecretSize - kStripe) / 8;
+constexpr size_t kBlock   = kStripe * kStripes;
+
+alignas(64) constexpr uint8_t kSecret[kSecretSize] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+inline uint64_t rotl64(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+inline uint64_t bswap64(uint64_t x) {
+    x = (x >> 32) | (x << 32);
+    x = ((x & 0xffff0000ffff0000) >> 16) | ((x & 0x0000ffff0000ffff) << 16);
+    return ((x & 0xff00ff00ff00ff00) >> 8) | ((x & 0x00ff00ff00ff00ff) << 8);
+}
+
+inline uint64_t mul128_fold64(uint64_t a, uint64_t b) {
+    uint64_t hi;
+    const uint64_t lo = hwy::Mul128(a, b, &hi);
+    return lo ^ hi;
+}
+
+inline uint64_t xxh64_avalanche(uint64_t h) {
+    h ^= h >> 33;
+    h *= P64_2;
+    h ^= h >> 29;
+    h *= P64_3;
+    return h ^ (h >> 32);
+}
+
+inline uint64_t avalanche(uint64_t h) {
+    h ^= h >> 37;
+    h *= 0x165667919e3779f9;
+    return h ^ (h >> 32);
+}
+
+inline uint64_t rrmxmx(uint64_t h, uint64_t len) {
+    h ^= rotl64(h, 49) ^ rotl64(h, 24);
+    h *= 0x9fb21c651e98df25;
+    h ^= (h >> 35) + len;
+    h *= 0x9fb21c651e98df25;
+    return h ^ (h >> 28);
+}
+
+inline uint64_t mix16(const uint8_t* p, const uint8_t* s, uint64_t seed) {
+    return mul128_fold64(load_le64(p) ^ (load_le64(s) + seed), load_le64(p + 8) ^ (load_le64(s + 8) - seed));
+}
+
+uint64_t hash_0to16(const uint8_t* p, size_t len, uint64_t seed) {
+    const uint8_t* s = kSecret;
+    if (len > 8) {
+        const uint64_t lo = load_le64(p) ^ ((load_le64(s + 24) ^ load_le64(s + 32)) + seed);
+        const uint64_t hi = load_le64(p + len - 8) ^ ((load_le64(s + 40) ^ load_le64(s + 48)) - seed);
+        return avalanche(len + bswap64(lo) + hi + mul128_fold64(lo, hi));
+    }
+    if (len >= 4) {
+        seed ^= bswap64((uint32_t)seed); /* the swapped low half into the high one */
+        const uint64_t x = (uint64_t)load_le32(p + len - 4) + ((uint64_t)load_le32(p) << 32);
+        return rrmxmx(x ^ ((load_le64(s + 8) ^ load_le64(s + 16)) - seed), len);
+    }
+    if (len > 0) {
+        const uint32_t combo = (uint32_t)p[0] << 16 | (uint32_t)p[len >> 1] << 24 | p[len - 1] |
+                               (uint32_t)len << 8;
+        return xxh64_avalanche(combo ^ ((uint64_t)(load_le32(s) ^ load_le32(s + 4)) + seed));
+    }
+    return xxh64_avalanche(seed ^ load_le64(s + 56) ^ load_le64(s + 64));
+}
+
+uint64_t hash_17to128(const uint8_t* p, size_t len, uint64_t seed) {
+    const uint8_t* s = kSecret;
+    uint64_t acc     = len * P64_1;
+    if (len > 32) {
+        if (len > 64) {
+            if (len > 96) {
+                acc += mix16(p + 48, s + 96, seed);
+                acc += mix16(p + len - 64, s + 112, seed);
+            }
+            acc += mix16(p + 32, s + 64, seed);
+            acc += mix16(p + len - 48, s + 80, seed);
+        }
+        acc += mix16(p + 16, s + 32, seed);
+        acc += mix16(p + len - 32, s + 48, seed);
+    }
+    acc += mix16(p, s, seed);
+    acc += mix16(p + len - 16, s + 16, seed);
+    return avalanche(acc);
+}
+
+uint64_t hash_129to240(const uint8_t* p, size_t len, uint64_t seed) {
+    const uint8_t* s = kSecret;
+    uint64_t acc     = len * P64_1;
+    size_t i         = 0;
+    for (; i < 8; ++i) {
+        acc += mix16(p + 16 * i, s + 16 * i, seed);
+    }
+    acc = avalanche(acc);
+    for (; i < len / 16; ++i) {
+        acc += mix16(p + 16 * i, s + 16 * (i - 8) + 3, seed);
+    }
+    acc += mix16(p + len - 16, s + 136 - 17, seed);
+    return avalanche(acc);
+}
+
+/// The secret of a seed for the long inputs
+void derive_secret(uint8_t* out, uint64_t seed) {
+    for (size_t i = 0; i < kSecretSize; i += 16) {
+        const uint64_t lo = load_le64(kSecret + i) + seed;
+        const uint64_t hi = load_le64(kSecret + i + 8) - seed;
+        for (int b = 0; b < 8; ++b) {
+            out[i + b]     = (uint8_t)(lo >> (8 * b));
+            out[i + 8 + b] = (uint8_t)(hi >> (8 * b));
+        }
+    }
+}
+
+using D64 = hn::CappedTag<uint64_t, 8>;
+
+/// Adds `stripes` stripes of 64 bytes to the 8 accumulators, the secret moving 8 bytes a
+/// stripe. Every lane only sees its own word and the other one of its 128 bit pair, so each
+/// vector of lanes runs the whole block on its own.
+void accumulate(uint64_t* acc, const uint8_t* p, const uint8_t* s, size_t stripes) {
+#if defined(LC_IS_BIG_ENDIAN)
+    for (size_t t = 0; t < stripes; ++t, p += kStripe, s += 8) {
+        for (size_t k = 0; k < 8; ++k) {
+            const uint64_t x  = load_le64(p + 8 * k);
+            const uint64_t xs = x ^ load_le64(s + 8 * k);
+            acc[k ^ 1] += x;
+            acc[k] += (xs & 0xffffffff) * (xs >> 32);
+        }
+    }
+#else
+    const D64 d;
+    const hn::Repartition<uint32_t, D64> d32;
+    const hn::Repartition<uint8_t, D64> d8;
+    const size_t N = hn::Lanes(d);
+    for (size_t k = 0; k < 8; k += N) {
+        auto a = hn::Load(d, acc + k);
+        for (size_t t = 0; t < stripes; ++t) {
+            const auto x  = hn::BitCast(d, hn::LoadU(d8, p + t * kStripe + 8 * k));
+            const auto xs = hn::Xor(x, hn::BitCast(d, hn::LoadU(d8, s + t * 8 + 8 * k)));
+            const auto m  = hn::MulEven(hn::BitCast(d32, xs), hn::BitCast(d32, hn::ShiftRight<32>(xs)));
+            a             = hn::Add(a, hn::Add(m, hn::Reverse2(d, x)));
+        }
+        hn::Store(a, d, acc + k);
+    }
+#endif
+}
+
+void scramble(uint64_t* acc, const uint8_t* s) {
+#if defined(LC_IS_BIG_ENDIAN)
+    for (size_t k = 0; k < 8; ++k) {
+        const uint64_t a = acc[k] ^ (acc[k] >> 47) ^ load_le64(s + 8 * k);
+        acc[k]           = a * P32_1;
+    }
+#else
+    const D64 d;
+    const hn::Repartition<uint32_t, D64> d32;
+    const hn::Repartition<uint8_t, D64> d8;
+    const size_t N   = hn::Lanes(d);
+    const auto prime = hn::Set(d32, P32_1);
+    for (size_t k = 0; k < 8; k += N) {
+        auto a        = hn::Load(d, acc + k);
+        a             = hn::Xor(a, hn::ShiftRight<47>(a));
+        a             = hn::Xor(a, hn::BitCast(d, hn::LoadU(d8, s + 8 * k)));
+        const auto lo = hn::MulEven(hn::BitCast(d32, a), prime);
+        const auto hi = hn::MulEven(hn::BitCast(d32, hn::ShiftRight<32>(a)), prime);
+        hn::Store(hn::Add(lo, hn::ShiftLeft<32>(hi)), d, acc + k);
+    }
+#endif
+}
+
+uint64_t hash_long(const uint8_t* p, size_t len, const uint8_t* s) {
+    HWY_ALIGN uint64_t acc[8] = {P32_3, P64_1, P64_2, P64_3, P64_4, P32_2, P64_5, P32_1};
+    const size_t blocks       = (len - 1) / kBlock;
+    for (size_t b = 0; b < blocks; ++b) {
+        accumulate(acc, p + b * kBlock, s, kStripes);
+        scramble(acc, s + kSecretSize - kStripe);
+    }
+    accumulate(acc, p + blocks * kBlock, s, (len - 1 - blocks * kBlock) / kStripe);
+    accumulate(acc, p + len - kStripe, s + kSecretSize - kStripe - 7, 1);
+
+    uint64_t h = len * P64_1;
+    for (size_t i = 0; i < 4; ++i) {
+        h += mul128_fold64(acc[2 * i] ^ load_le64(s + 11 + 16 * i),
+                           acc[2 * i + 1] ^ load_le64(s + 19 + 16 * i));
+    }
+    return avalanche(h);
+}
+
+/// `secret` is that of the seed, only read for inputs over 240 bytes
+uint64_t xxh3(const uint8_t* p, size_t len, uint64_t seed, const uint8_t* secret) {
+    if (len <= 16) {
+        return hash_0to16(p, len, seed);
+    }
+    if (len <= 128) {
+        return hash_17to128(p, len, seed);
+    }
+    if (len <= 240) {
+        return hash_129to240(p, len, seed);
+    }
+    return hash_long(p, len, secret);
+}
+
+// SipHash
+
+struct scalar_ops {
+    using T = uint64_t;
+    static T add(T a, T b) { return a + b; }
+    static T xor_(T a, T b) { return a ^ b; }
+    template <int K>
+    static T rotl(T a) {
+        return rotl64(a, K);
+    }
+};
+
+template <typename D>
+struct lanes_ops {
+    using T = hn::Vec<D>;
+    static T add(T a, T b) { return hn::Add(a, b); }
+    static T xor_(T a, T b) { return hn::Xor(a, b); }
+    template <int K>
+    static T rotl(T a) {
+        return hn::RotateRight<64 - K>(a);
+    }
+};
+
+template <typename Ops, typename T>
+inline void sipround(T& v0, T& v1, T& v2, T& v3) {
+    v0 = Ops::add(v0, v1);
+    v1 = Ops::xor_(Ops::template rotl<13>(v1), v0);
+    v0 = Ops::template rotl<32>(v0);
+    v2 = Ops::add(v2, v3);
+    v3 = Ops::xor_(Ops::template rotl<16>(v3), v2);
+    v0 = Ops::add(v0, v3);
+    v3 = Ops::xor_(Ops::template rotl<21>(v3), v0);
+    v2 = Ops::add(v2, v1);
+    v1 = Ops::xor_(Ops::template rotl<17>(v1), v2);
+    v2 = Ops::template rotl<32>(v2);
+}
+
+/// The initial state of a key
+void sip_init(const lc::siphash_key& key, uint64_t* v) {
+    const uint64_t k0 = load_le64(key.data()), k1 = load_le64(key.data() + 8);
+    v[0]              = k0 ^ 0x736f6d6570736575;
+    v[1]              = k1 ^ 0x646f72616e646f6d;
+    v[2]              = k0 ^ 0x6c7967656e657261;
+    v[3]              = k1 ^ 0x7465646279746573;
+}
+
+/// The last word: the 0 to 7 remaining bytes and the length in the top byte
+inline uint64_t sip_last(const uint8_t* p, size_t len) {
+    uint64_t b       = (uint64_t)len << 56;
+    const uint8_t* r = p + len / 8 * 8;
+    for (size_t i = 0; i < len % 8; ++i) {
+        b |= (uint64_t)r[i] << (8 * i);
+    }
+    return b;
+}
+
+template <int C, int D>
+uint64_t siphash(const lc::siphash_key& key, const uint8_t* p, size_t len) {
+    uint64_t v[4];
+    sip_init(key, v);
+    uint64_t v0 = v[0], v1 = v[1], v2 = v[2], v3 = v[3];
+    const auto word = [&](uint64_t m) {
+        v3 ^= m;
+        for (int r = 0; r < C; ++r) {
+            sipround<scalar_ops>(v0, v1, v2, v3);
+        }
+        v0 ^= m;
+    };
+    for (size_t i = 0; i < len / 8; ++i) {
+        word(load_le64(p + 8 * i));
+    }
+    word(sip_last(p, len));
+    v2 ^= 0xff;
+    for (int r = 0; r < D; ++r) {
+        sipround<scalar_ops>(v0, v1, v2, v3);
+    }
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+/// SipHash of a key per u64 lane. A step is C rounds over a word per lane: the message words,
+/// the last word, then the D finalization rounds as D / C steps over a zero word with 0xff
+/// into v2 on the first. A lane takes the next key as soon as its own is done.
+template <int C, int D>
+void siphash_lanes(const lc::siphash_key& key, const std::string_view* keys, size_t n,
+                   uint64_t* out) {
+    static_assert(D % C == 0, "finalization in whole steps");
+    using DU = hn::ScalableTag<uint64_t>;
+    using Ops = lanes_ops<DU>;
+    const DU d;
+    const size_t N            = hn::Lanes(d);
+    constexpr size_t kMaxLane = hn::MaxLanes(DU());
+
+    struct job {
+        const uint8_t* data;
+        size_t words, steps, at, msg;
+        uint64_t last;
+        bool live;
+    };
+    job jobs[kMaxLane];
+    uint64_t iv[4];
+    sip_init(key, iv);
+    HWY_ALIGN uint64_t st[4][kMaxLane];
+    HWY_ALIGN uint64_t m[kMaxLane], f[kMaxLane];
+    size_t next = 0, busy = 0;
+
+    const auto start = [&](size_t l) {
+        job& j = jobs[l];
+        j.live = next != n;
+        if (!j.live) {
+            return;
+        }
+        const std::string_view s = keys[next];
+        j.data                   = (const uint8_t*)s.data();
+        j.words                  = s.size() / 8;
+        j.steps                  = j.words + 1 + D / C;
+        j.last                   = sip_last(j.data, s.size());
+        j.at                     = 0;
+        j.msg                    = next++;
+        for (size_t k = 0; k < 4; ++k) {
+            st[k][l] = iv[k];
+        }
+        ++busy;
+    };
+    for (size_t l = 0; l < N; ++l) {
+        start(l);
+    }
+
+    auto v0 = hn::Load(d, st[0]), v1 = hn::Load(d, st[1]), v2 = hn::Load(d, st[2]),
+         v3 = hn::Load(d, st[3]);
+    while (busy != 0) {
+        for (size_t l = 0; l < N; ++l) {
+            const job& j = jobs[l];
+            m[l]         = !j.live               ? 0
+                           : j.at < j.words      ? load_le64(j.data + 8 * j.at)
+                           : j.at == j.words     ? j.last
+                                                 : 0;
+            f[l]         = j.live && j.at == j.words + 1 ? 0xff : 0;
+        }
+        const auto vm = hn::Load(d, m);
+        v3            = hn::Xor(v3, vm);
+        v2            = hn::Xor(v2, hn::Load(d, f));
+        for (int r = 0; r < C; ++r) {
+            sipround<Ops>(v0, v1, v2, v3);
+        }
+        v0 = hn::Xor(v0, vm);
+
+        bool done = false;
+        for (size_t l = 0; l < N; ++l) {
+            job& j = jobs[l];
+            done |= j.live && ++j.at == j.steps;
+        }
+        if (!done) {
+            continue;
+        }
+        hn::Store(v0, d, st[0]);
+        hn::Store(v1, d, st[1]);
+        hn::Store(v2, d, st[2]);
+        hn::Store(v3, d, st[3]);
+        for (size_t l = 0; l < N; ++l) {
+            job& j = jobs[l];
+            if (j.live && j.at == j.steps) {
+                out[j.msg] = st[0][l] ^ st[1][l] ^ st[2][l] ^ st[3][l];
+                --busy;
+                start(l);
+            }
+        }
+        v0 = hn::Load(d, st[0]);
+        v1 = hn::Load(d, st[1]);
+        v2 = hn::Load(d, st[2]);
+        v3 = hn::Load(d, st[3]);
+    }
+}
+
+template <int C, int D>
+void siphash_batch(const lc::siphash_key& key, const std::string_view* keys, size_t n,
+                   uint64_t* out) {
+    // 64 bit rotates take three ops below 4 lanes, the scalar rounds are as fast there
+    if (hn::Lanes(hn::ScalableTag<uint64_t>()) < 4 || n < 4) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = siphash<C, D>(key, (const uint8_t*)keys[i].data(), keys[i].size());
+        }
+        return;
+    }
+    siphash_lanes<C, D>(key, keys, n, out);
+}
+
+}  // namespace
+
+namespace lc {
+
+uint64_t hash64(const void* data, size_t len, uint64_t seed) {
+    const uint8_t* p = (const uint8_t*)data;
+    if (len <= 240 || seed == 0) {
+        return xxh3(p, len, seed, kSecret);
+    }
+    alignas(64) uint8_t secret[kSecretSize];
+    derive_secret(secret, seed);
+    return xxh3(p, len, seed, secret);
+}
+
+void hash64_batch(const std::string_view* keys, size_t n, uint64_t* out, uint64_t seed) {
+    alignas(64) uint8_t derived[kSecretSize];
+    const uint8_t* secret = kSecret;
+    for (size_t i = 0; i < n; ++i) {
+        const uint8_t* p = (const uint8_t*)keys[i].data();
+        const size_t len = keys[i].size();
+        if (len > 240 && seed != 0 && secret == kSecret) {
+            derive_secret(derived, seed);
+            secret = derived;
+        }
+        out[i] = xxh3(p, len, seed, secret);
+    }
+}
+
+uint64_t siphash24(const siphash_key& key, const void* data, size_t len) {
+    return siphash<2, 4>(key, (const uint8_t*)data, len);
+}
+
+uint64_t siphash13(const siphash_key& key, const void* data, size_t len) {
+    return siphash<1, 3>(key, (const uint8_t*)data, len);
+}
+
+void siphash24_batch(const siphash_key& key, const std::string_view* keys, size_t n,
+                     uint64_t* out) {
+    siphash_batch<2, 4>(key, keys, n, out);
+}
+
+void siphash13_batch(const siphash_key& key, const std::string_view* keys, size_t n,
+                     uint64_t* out) {
+    siphash_batch<1, 3>(key, keys, n, out);
+}
+
+}  // namespace lc
@@ -1,3 +1,4 @@
+#include "detail/hex.h"
 #include "detail/hwy.h"
 #include "lcrypt/hex.h"
 #include <stdexcept>
@@ -7,18 +8,6 @@
 
 namespace unsimd {
 
-#define HEX(v, c)                              \
-    {                                          \
-        char tmp = (char)c;                    \
-        if (tmp >= '0' && tmp <= '9') {        \
-            v = tmp - '0';                     \
-        } else if (tmp >= 'A' && tmp <= 'F') { \
-            v = tmp - 'A' + 10;                \
-        } else {                               \
-            v = tmp - 'a' + 10;                \
-        }                                      \
-    }
-
 void hex__marshal(const char* in, size_t insize, char* out) {
     static char _hex[]  = "0123456789abcdef";
     const uint8_t* text = (const uint8_t*)(in);
@@ -33,10 +22,9 @@ void hex__unmarshal(const char* in, size_t insize, char* out) {
         throw std::runtime_error("Invalid hex text size");
     }
     for (int i = 0; i < (int)insize; i += 2) {
-        uint8_t hi, low;
-        HEX(hi, in[i]);
-        HEX(low, in[i + 1]);
-        if (hi > 16 || low > 16) {
+        uint8_t hi  = lc::detail::hex_nibble(in[i]);
+        uint8_t low = lc::detail::hex_nibble(in[i + 1]);
+        if (hi > 15 || low > 15) {
             fprintf(stderr, "hi:%d, lo:%d, %c\n", hi, low, in[i + 1]);
             throw std::runtime_error("Invalid hex text");
         }
@@ -70,25 +58,16 @@ struct EncodeUnit : hn::UnrollerUnit<EncodeUnit, u8, u8> {
 
 struct DecodeUnit : hn::UnrollerUnit2D<DecodeUnit, u8, u8, u8> {
     using D = hn::ScalableTag<u8>;
-    const vu8 _f             = hn::Set(_du8, 0xF);
-    // clang-format off
-    const vu8 _hex_lut = hn::Dup128VecFromValues(_du8,
-        /* 0 */ 0x10,        /* 1 */ 0x00,        /* 2 */ 0x00,        /* 3 */ 0x00 - 0x30,
-        /* 4 */ 0x0A - 0x41, /* 5 */ 0x00,        /* 6 */ 0x0A - 0x61, /* 7 */ 0x00,
-        /* 8 */ 0x00,        /* 9 */ 0x00,        /* a */ 0x00,        /* b */ 0x00,
-        /* c */ 0x00,        /* d */ 0x00,        /* e */ 0x00,        /* f */ 0x00);
-    // clang-format on
+    const lc::detail::HexNibbleLut _lut;
     vu8 _x0 = hn::Zero(_du8);
     vu8 _x1 = hn::Zero(_du8);
 
     inline vu8 lookup_pshufb(const vu8& xx) {
-        const auto higher_nibble = hn::ShiftRightSame(xx, 4);
-        const auto result        = hn::Add(xx, hn::TableLookupBytes(_hex_lut, higher_nibble));
-        auto idx                 = hn::FindFirstTrue(_du8, hn::Gt(result, _f));
+        auto idx = hn::FindFirstTrue(_du8, hn::Not(_lut.Valid(xx)));
         if (HWY_UNLIKELY(idx != -1)) {
             throw lc::input_error(idx, 0);
         }
-        return result;
+        return _lut.Decode(xx);
     }
 
     vu8 Func(const ptrdiff_t idx, const vu8 x0, const vu8 x1, const vu8) {
@@ -121,19 +100,23 @@ struct DecodeUnit : hn::UnrollerUnit2D<DecodeUnit, u8, u8, u8> {
 
 namespace lc {
 
-std::string hex_encode(const char* in, size_t len) {
+void detail::hex_encode_to(const char* in, size_t len, char* out) {
     static constexpr HWY_FULL(u8) _du8{};
     static constexpr size_t N8 = hn::Lanes(_du8);
     size_t mod                 = len % N8;
-    std::string result(2 * len, '\0');
     if (len > mod) {
-        EncodeUnit unit((u8*)result.data());
-        hn::Unroller(unit, (u8*)(const_cast<char*>(in)), (u8*)result.data(), len - mod);
+        EncodeUnit unit((u8*)out);
+        hn::Unroller(unit, (u8*)(const_cast<char*>(in)), (u8*)out, len - mod);
     }
     if (mod > 0) {
         int start = len - mod;
-        unsimd::hex__marshal(in + start, mod, &result[start * 2]);
+        unsimd::hex__marshal(in + start, mod, out + start * 2);
     }
+}
+
+std::string hex_encode(const char* in, size_t len) {
+    std::string result(2 * len, '\0');
+    detail::hex_encode_to(in, len, result.data());
     return result;
 }
 
@@ -0,0 +1,76 @@
+#include "lcrypt/hmac.h"
+#include "detail/entropy.h"
+#include "detail/sha256.h"
+#include <vector>
+#include <string.h>
+
+namespace lc {
+
+hmac_sha256_key::hmac_sha256_key(const void* key, size_t len) {
+    uint8_t k[sha256::kBlockSize] = {0};
+    if (len > sha256::kBlockSize) {
+        const auto d = sha256::hash(key, len);
+        memcpy(k, d.data(), d.size());
+    } else if (len != 0) {
+        memcpy(k, key, len);
+    }
+    uint8_t pad[sha256::kBlockSize];
+    for (size_t i = 0; i < sizeof(pad); ++i) {
+        pad[i] = k[i] ^ 0x36;
+    }
+    memcpy(inner_, sha256().state(), sizeof(inner_));
+    detail::sha256_compress(inner_, pad, 1);
+    for (size_t i = 0; i < sizeof(pad); ++i) {
+        pad[i] = k[i] ^ 0x5c;
+    }
+    memcpy(outer_, sha256().state(), sizeof(outer_));
+    detail::sha256_compress(outer_, pad, 1);
+    detail::secure_zero(k, sizeof(k));
+    detail::secure_zero(pad, sizeof(pad));
+}
+
+hmac_sha256_key::~hmac_sha256_key() {
+    detail::secure_zero(inner_, sizeof(inner_));
+    detail::secure_zero(outer_, sizeof(outer_));
+}
+
+hmac_sha256_key::digest_t hmac_sha256_key::sign(const void* msg, size_t len) const {
+    sha256 in(inner_, sha256::kBlockSize);
+    const auto d = in.update(msg, len).digest();
+    sha256 out(outer_, sha256::kBlockSize);
+    return out.update(d.data(), d.size()).digest();
+}
+
+bool hmac_sha256_key::verify(const void* msg, size_t len, const void* mac, size_t mac_len) const {
+    if (mac_len != sha256::kDigestSize) {
+        return false;
+    }
+    const auto d = sign(msg, len);
+    return constant_time_equal(d.data(), mac, d.size());
+}
+
+void hmac_sha256_key::sign_batch(const std::string_view* msgs, size_t n, digest_t* out) const {
+    detail::sha256_batch(msgs, n, out, inner_, sha256::kBlockSize);
+    // The inner digests are the messages of the outer pass. Each is read into its padding
+    // block before its own slot is written, so they are hashed in place.
+    std::vector<std::string_view> inner(n);
+    for (size_t i = 0; i < n; ++i) {
+        inner[i] = std::string_view((const char*)out[i].data(), out[i].size());
+    }
+    detail::sha256_batch(inner.data(), n, out, outer_, sha256::kBlockSize);
+}
+
+void hmac_sha256_key::verify_batch(const std::string_view* msgs, const digest_t* macs, size_t n,
+                                   bool* ok) const {
+    std::vector<digest_t> d(n);
+    sign_batch(msgs, n, d.data());
+    for (size_t i = 0; i < n; ++i) {
+        ok[i] = constant_time_equal(d[i].data(), macs[i].data(), d[i].size());
+    }
+}
+
+sha256::digest_t hmac_sha256(const void* key, size_t key_len, const void* msg, size_t len) {
+    return hmac_sha256_key(key, key_len).sign(msg, len);
+}
+
+}  // namespace lc
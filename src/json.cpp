@@ -0,0 +1,195 @@
+#include "lcrypt/json.h"
+#include "detail/hex.h"
+#include "detail/hwy.h"
+#include "detail/utf8.h"
+#include <string>
+#include <string.h>
+
+namespace {
+
+struct EscapeClassifier {
+    const vu8 _quote     = hn::Set(_du8, '"');
+    const vu8 _backslash = hn::Set(_du8, '\\');
+    const vu8 _0x20      = hn::Set(_du8, 0x20);
+
+    /// lanes that need escaping
+    hn::Mask<HWY_FULL(u8)> Special(const vu8 x) const {
+        return hn::Or(hn::Or(hn::Eq(x, _quote), hn::Eq(x, _backslash)), hn::Lt(x, _0x20));
+    }
+
+    /// control bytes with a two-byte escape (\b \t \n \f \r)
+    hn::Mask<HWY_FULL(u8)> ShortControl(const vu8 x) const {
+        const auto m0 = hn::Or(hn::Eq(x, hn::Set(_du8, '\b')), hn::Eq(x, hn::Set(_du8, '\t')));
+        const auto m1 = hn::Or(hn::Eq(x, hn::Set(_du8, '\n')), hn::Eq(x, hn::Set(_du8, '\f')));
+        return hn::Or(hn::Or(m0, m1), hn::Eq(x, hn::Set(_du8, '\r')));
+    }
+};
+
+inline size_t escape_one(u8 c, u8* out) {
+    static constexpr char _hex[] = "0123456789abcdef";
+    out[0]                       = '\\';
+    switch (c) {
+    case '"': out[1] = '"'; return 2;
+    case '\\': out[1] = '\\'; return 2;
+    case '\b': out[1] = 'b'; return 2;
+    case '\t': out[1] = 't'; return 2;
+    case '\n': out[1] = 'n'; return 2;
+    case '\f': out[1] = 'f'; return 2;
+    case '\r': out[1] = 'r'; return 2;
+    default:
+        out[1] = 'u';
+        out[2] = '0';
+        out[3] = '0';
+        out[4] = _hex[c >> 4];
+        out[5] = _hex[c & 0xf];
+        return 6;
+    }
+}
+
+inline uint32_t unhex4(const u8* p, size_t ofs) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) {
+        const u8 n = lc::detail::hex_nibble(p[ofs + i]);
+        if (HWY_UNLIKELY(n > 15)) {
+            throw lc::input_error(ofs + i, p[ofs + i]);
+        }
+        v = (v << 4) | n;
+    }
+    return v;
+}
+
+/// `p[i]` is a backslash, returns the bytes consumed from `p`
+inline size_t unescape_one(const u8* p, size_t len, size_t i, u8* out, size_t& j) {
+    if (HWY_UNLIKELY(i + 1 >= len)) {
+        throw lc::input_error(i, p[i]);
+    }
+    const u8 c = p[i + 1];
+    switch (c) {
+    case '"':
+    case '\\':
+    case '/': out[j++] = c; return 2;
+    case 'b': out[j++] = '\b'; return 2;
+    case 't': out[j++] = '\t'; return 2;
+    case 'n': out[j++] = '\n'; return 2;
+    case 'f': out[j++] = '\f'; return 2;
+    case 'r': out[j++] = '\r'; return 2;
+    case 'u': {
+        if (HWY_UNLIKELY(i + 6 > len)) {
+            throw lc::input_error(i, c);
+        }
+        uint32_t cp = unhex4(p, i + 2);
+        size_t used = 6;
+        if (cp >= 0xd800 && cp <= 0xdbff) {
+            // high surrogate, must be followed by \uDC00-\uDFFF
+            if (HWY_UNLIKELY(i + 12 > len || p[i + 6] != '\\' || p[i + 7] != 'u')) {
+                throw lc::input_error(i, c);
+            }
+            const uint32_t lo = unhex4(p, i + 8);
+            if (HWY_UNLIKELY(lo < 0xdc00 || lo > 0xdfff)) {
+                throw lc::input_error(i + 6, p[i + 6]);
+            }
+            cp   = 0x10000 + (((cp - 0xd800) << 10) | (lo - 0xdc00));
+            used = 12;
+        } else if (HWY_UNLIKELY(cp >= 0xdc00 && cp <= 0xdfff)) {
+            throw lc::input_error(i, c);
+        }
+        j += lc::detail::utf8_encode(cp, out + j);
+        return used;
+    }
+    default: throw lc::input_error(i + 1, c);
+    }
+}
+
+}  // namespace
+
+namespace lc {
+
+size_t json_escape_size(const char* in, size_t len) {
+    const EscapeClassifier cls;
+    const u8* p  = (const u8*)in;
+    size_t extra = 0;
+    for (size_t i = 0; i < len; i += N8) {
+        const size_t n   = HWY_MIN(N8, len - i);
+        const auto valid = hn::FirstN(_du8, n);
+        const auto x     = hn::LoadN(_du8, p + i, n);
+        const auto m     = hn::And(cls.Special(x), valid);
+        if (hn::AllFalse(_du8, m)) {
+            continue;
+        }
+        // "\u00XX" for control bytes without a short form
+        const auto ctrl     = hn::And(hn::Lt(x, hn::Set(_du8, 0x20)), valid);
+        const size_t nctrl  = hn::CountTrue(_du8, ctrl);
+        const size_t nshort = hn::CountTrue(_du8, hn::And(cls.ShortControl(x), valid));
+        extra += hn::CountTrue(_du8, m) + 4 * (nctrl - nshort);
+    }
+    return len + extra;
+}
+
+size_t json_escape(const char* in, size_t len, char* out) {
+    const EscapeClassifier cls;
+    const u8* p = (const u8*)in;
+    u8* o       = (u8*)out;
+    size_t j    = 0;
+    for (size_t i = 0; i < len; i += N8) {
+        const size_t n = HWY_MIN(N8, len - i);
+        const auto x   = hn::LoadN(_du8, p + i, n);
+        const auto m   = hn::And(cls.Special(x), hn::FirstN(_du8, n));
+        if (hn::AllFalse(_du8, m)) {
+            // clean block
+            hn::StoreN(x, _du8, o + j, n);
+            j += n;
+            continue;
+        }
+        size_t k = 0;
+        for (uint64_t bits = MaskBits(_du8, m); bits != 0; bits &= bits - 1) {
+            const size_t b = hwy::Num0BitsBelowLS1Bit_Nonzero64(bits);
+            hwy::CopyBytes(p + i + k, o + j, b - k);
+            j += b - k;
+            j += escape_one(p[i + b], o + j);
+            k = b + 1;
+        }
+        hwy::CopyBytes(p + i + k, o + j, n - k);
+        j += n - k;
+    }
+    return j;
+}
+
+size_t json_unescape(const char* in, size_t len, char* out) {
+    const vu8 _backslash = hn::Set(_du8, '\\');
+    const u8* p          = (const u8*)in;
+    u8* o                = (u8*)out;
+    size_t i             = 0;
+    size_t j             = 0;  // j <= i
+    while (i < len) {
+        const size_t n   = HWY_MIN(N8, len - i);
+        const auto x     = hn::LoadN(_du8, p + i, n);
+        const auto m     = hn::And(hn::Eq(x, _backslash), hn::FirstN(_du8, n));
+        const intptr_t b = hn::FindFirstTrue(_du8, m);
+        if (b < 0) {
+            // clean block
+            hn::StoreN(x, _du8, o + j, n);
+            i += n;
+            j += n;
+            continue;
+        }
+        hwy::CopyBytes(p + i, o + j, b);
+        i += b;
+        j += b;
+        i += unescape_one(p, len, i, o, j);
+    }
+    return j;
+}
+
+std::string json_escape(const char* in, size_t len) {
+    std::string result(json_escape_size(in, len), '\0');
+    json_escape(in, len, result.data());
+    return result;
+}
+
+std::string json_unescape(const char* in, size_t len) {
+    std::string result(len, '\0');
+    result.resize(json_unescape(in, len, result.data()));
+    return result;
+}
+
+}  // namespace lc
@@ -0,0 +1,156 @@
+#include "lcrypt/md5.h"
+#include "detail/hwy.h"
+#include "detail/multibuffer.h"
+#include <string.h>
+
+namespace {
+
+using lc::detail::load_le32;
+
+constexpr uint32_t IV[4] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476};
+
+/// floor(abs(sin(i + 1)) * 2^32)
+constexpr uint32_t K[64] = {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391,
+};
+
+/// The message word of step i
+constexpr int word(int i) {
+    return i < 16 ? i : i < 32 ? (5 * i + 1) % 16 : i < 48 ? (3 * i + 5) % 16 : (7 * i) % 16;
+}
+
+/// The four steps of a round, the shifts of the round are compile time constants for the
+/// vector rotates. `F` is the round function, `step` does a = b + rotl(a + F + K + m, s).
+template <int S0, int S1, int S2, int S3, typename T, typename Step>
+inline void quad(T& a, T& b, T& c, T& d, int i, Step&& step) {
+    step.template run<S0>(a, b, c, d, i);
+    step.template run<S1>(d, a, b, c, i + 1);
+    step.template run<S2>(c, d, a, b, i + 2);
+    step.template run<S3>(b, c, d, a, i + 3);
+}
+
+template <typename T, typename Ops>
+inline void rounds(T* h, const T* m, Ops& ops) {
+    T a = h[0], b = h[1], c = h[2], d = h[3];
+    for (int i = 0; i < 16; i += 4) {
+        quad<7, 12, 17, 22>(a, b, c, d, i, ops);
+    }
+    for (int i = 16; i < 32; i += 4) {
+        quad<5, 9, 14, 20>(a, b, c, d, i, ops);
+    }
+    for (int i = 32; i < 48; i += 4) {
+        quad<4, 11, 16, 23>(a, b, c, d, i, ops);
+    }
+    for (int i = 48; i < 64; i += 4) {
+        quad<6, 10, 15, 21>(a, b, c, d, i, ops);
+    }
+    h[0] = ops.add(h[0], a);
+    h[1] = ops.add(h[1], b);
+    h[2] = ops.add(h[2], c);
+    h[3] = ops.add(h[3], d);
+}
+
+struct scalar_ops {
+    const uint32_t* m;
+
+    static uint32_t add(uint32_t x, uint32_t y) { return x + y; }
+
+    template <int S>
+    void run(uint32_t& a, uint32_t b, uint32_t c, uint32_t d, int i) const {
+        const uint32_t f = i < 16   ? (d ^ (b & (c ^ d)))
+                           : i < 32 ? (c ^ (d & (b ^ c)))
+                           : i < 48 ? (b ^ c ^ d)
+                                    : (c ^ (b | ~d));
+        const uint32_t x = a + f + K[i] + m[word(i)];
+        a                = b + ((x << S) | (x >> (32 - S)));
+    }
+};
+
+void compress(uint32_t* h, const uint8_t* p, size_t blocks) {
+    for (; blocks != 0; --blocks, p += 64) {
+        uint32_t m[16];
+        for (int t = 0; t < 16; ++t) {
+            m[t] = load_le32(p + 4 * t);
+        }
+        scalar_ops ops{m};
+        rounds(h, m, ops);
+    }
+}
+
+/// MD5 over a message per u32 lane, for detail::hash_lanes
+struct lanes128 {
+    static constexpr size_t kWords      = 4;
+    static constexpr size_t kDigestSize = 16;
+    static constexpr bool kBigEndian    = false;
+
+    template <class D>
+    struct ops {
+        using V = hn::Vec<D>;
+        D d;
+        const V* m;
+
+        static V add(V x, V y) { return hn::Add(x, y); }
+
+        template <int S>
+        void run(V& a, V b, V c, V dd, int i) const {
+            const V f = i < 16   ? hn::Xor(dd, hn::And(b, hn::Xor(c, dd)))
+                        : i < 32 ? hn::Xor(c, hn::And(dd, hn::Xor(b, c)))
+                        : i < 48 ? hn::Xor3(b, c, dd)
+                                 : hn::Xor(c, hn::Or(b, hn::Not(dd)));
+            const V x = hn::Add(hn::Add(a, f), hn::Add(hn::Set(d, K[i]), m[word(i)]));
+            a         = hn::Add(b, hn::RotateRight<32 - S>(x));
+        }
+    };
+
+    template <class D, class V = hn::Vec<D>>
+    static void compress(D d, V* h, const V* m) {
+        ops<D> o{d, m};
+        rounds(h, m, o);
+    }
+};
+
+}  // namespace
+
+namespace lc {
+
+void md5::reset() {
+    memcpy(h_, IV, sizeof(h_));
+    len_ = 0;
+}
+
+md5& md5::update(const void* data, size_t len) {
+    detail::md_update(buf_, len_, (const uint8_t*)data, len,
+                      [this](const uint8_t* p, size_t blocks) { compress(h_, p, blocks); });
+    return *this;
+}
+
+md5::digest_t md5::digest() {
+    uint8_t tail[2 * kBlockSize];
+    const size_t n = detail::md_pad(tail, buf_, len_, 0, false);
+    compress(h_, tail, n);
+    digest_t out;
+    for (int i = 0; i < 4; ++i) {
+        detail::store_le32(out.data() + 4 * i, h_[i]);
+    }
+    reset();
+    return out;
+}
+
+md5::digest_t md5::hash(const void* data, size_t len) {
+    md5 h;
+    h.update(data, len);
+    return h.digest();
+}
+
+void md5_batch(const std::string_view* msgs, size_t n, md5::digest_t* out) {
+    detail::hash_lanes<lanes128>(msgs, n, out, IV);
+}
+
+}  // namespace lc
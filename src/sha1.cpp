@@ -0,0 +1,189 @@
+#include "lcrypt/sha1.h"
+#include "detail/base64.h"
+#include "detail/hwy.h"
+#include "detail/multibuffer.h"
+#include <string.h>
+#if defined(__SHA__) && defined(__SSE4_1__)
+#include <immintrin.h>
+#define LC_SHA_NI 1
+#else
+#define LC_SHA_NI 0
+#endif
+
+namespace {
+
+using lc::detail::load_be32;
+
+constexpr uint32_t IV[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+constexpr uint32_t K[4]  = {0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xca62c1d6};
+
+inline uint32_t rotl(uint32_t x, int n) {
+    return (x << n) | (x >> (32 - n));
+}
+
+void compress_scalar(uint32_t* h, const uint8_t* p, size_t blocks) {
+    for (; blocks != 0; --blocks, p += 64) {
+        uint32_t w[80];
+        for (int t = 0; t < 16; ++t) {
+            w[t] = load_be32(p + 4 * t);
+        }
+        for (int t = 16; t < 80; ++t) {
+            w[t] = rotl(w[t - 3] ^ w[t - 8] ^ w[t - 14] ^ w[t - 16], 1);
+        }
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int t = 0; t < 80; ++t) {
+            const uint32_t f = t < 20   ? (d ^ (b & (c ^ d)))
+                               : t < 40 ? (b ^ c ^ d)
+                               : t < 60 ? ((b & c) | (d & (b | c)))
+                                        : (b ^ c ^ d);
+            const uint32_t x = rotl(a, 5) + f + e + K[t / 20] + w[t];
+            e = d, d = c, c = rotl(b, 30), b = a, a = x;
+        }
+        h[0] += a, h[1] += b, h[2] += c, h[3] += d, h[4] += e;
+    }
+}
+
+#if LC_SHA_NI
+/// Four rounds per sha1rnds4, E rides in the top lane of a second register
+void compress_shani(uint32_t* h, const uint8_t* p, size_t blocks) {
+    const __m128i mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+    __m128i abcd       = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)h), 0x1b);
+    __m128i e0         = _mm_set_epi32((int)h[4], 0, 0, 0);
+
+    for (; blocks != 0; --blocks, p += 64) {
+        const __m128i abcd_save = abcd, e_save = e0;
+        __m128i m[4], e[2] = {e0, e0};
+        for (int i = 0; i < 20; ++i) {
+            if (i < 4) {
+                m[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(p + 16 * i)), mask);
+            }
+            const __m128i cur = m[i & 3];
+            __m128i& in       = e[i & 1];
+            in                = i == 0 ? _mm_add_epi32(in, cur) : _mm_sha1nexte_epu32(in, cur);
+            e[(i + 1) & 1]    = abcd;
+            if (i >= 3 && i <= 18) {
+                m[(i + 1) & 3] = _mm_sha1msg2_epu32(m[(i + 1) & 3], cur);
+            }
+            switch (i / 5) {
+                case 0: abcd = _mm_sha1rnds4_epu32(abcd, in, 0); break;
+                case 1: abcd = _mm_sha1rnds4_epu32(abcd, in, 1); break;
+                case 2: abcd = _mm_sha1rnds4_epu32(abcd, in, 2); break;
+                default: abcd = _mm_sha1rnds4_epu32(abcd, in, 3); break;
+            }
+            if (i >= 1 && i <= 16) {
+                m[(i + 3) & 3] = _mm_sha1msg1_epu32(m[(i + 3) & 3], cur);
+            }
+            if (i >= 2 && i <= 17) {
+                m[(i + 2) & 3] = _mm_xor_si128(m[(i + 2) & 3], cur);
+            }
+        }
+        e0   = _mm_sha1nexte_epu32(e[0], e_save);
+        abcd = _mm_add_epi32(abcd, abcd_save);
+    }
+
+    _mm_storeu_si128((__m128i*)h, _mm_shuffle_epi32(abcd, 0x1b));
+    h[4] = (uint32_t)_mm_extract_epi32(e0, 3);
+}
+#endif
+
+inline void compress(uint32_t* h, const uint8_t* p, size_t blocks) {
+#if LC_SHA_NI
+    compress_shani(h, p, blocks);
+#else
+    compress_scalar(h, p, blocks);
+#endif
+}
+
+/// SHA-1 over a message per u32 lane, for detail::hash_lanes
+struct lanes160 {
+    static constexpr size_t kWords      = 5;
+    static constexpr size_t kDigestSize = 20;
+    static constexpr bool kBigEndian    = true;
+
+    template <class D, class V = hn::Vec<D>>
+    static void compress(D d, V* h, const V* m) {
+        V w[16];
+        for (int t = 0; t < 16; ++t) {
+            w[t] = m[t];
+        }
+        V a = h[0], b = h[1], c = h[2], dd = h[3], e = h[4];
+        for (int t = 0; t < 80; ++t) {
+            if (t >= 16) {
+                const V x = hn::Xor(hn::Xor3(w[(t - 3) & 15], w[(t - 8) & 15], w[(t - 14) & 15]),
+                                    w[t & 15]);
+                w[t & 15] = hn::RotateRight<31>(x);
+            }
+            const V f = t < 20   ? hn::Xor(dd, hn::And(b, hn::Xor(c, dd)))
+                        : t < 40 ? hn::Xor3(b, c, dd)
+                        : t < 60 ? hn::Or(hn::And(b, c), hn::And(dd, hn::Or(b, c)))
+                                 : hn::Xor3(b, c, dd);
+            const V x = hn::Add(hn::Add(hn::RotateRight<27>(a), f),
+                                hn::Add(hn::Add(e, w[t & 15]), hn::Set(d, K[t / 20])));
+            e         = dd;
+            dd        = c;
+            c         = hn::RotateRight<2>(b);
+            b         = a;
+            a         = x;
+        }
+        h[0] = hn::Add(h[0], a);
+        h[1] = hn::Add(h[1], b);
+        h[2] = hn::Add(h[2], c);
+        h[3] = hn::Add(h[3], dd);
+        h[4] = hn::Add(h[4], e);
+    }
+};
+
+}  // namespace
+
+namespace lc {
+
+void sha1::reset() {
+    memcpy(h_, IV, sizeof(h_));
+    len_ = 0;
+}
+
+sha1& sha1::update(const void* data, size_t len) {
+    detail::md_update(buf_, len_, (const uint8_t*)data, len,
+                      [this](const uint8_t* p, size_t blocks) { compress(h_, p, blocks); });
+    return *this;
+}
+
+sha1::digest_t sha1::digest() {
+    uint8_t tail[2 * kBlockSize];
+    const size_t n = detail::md_pad(tail, buf_, len_, 0, true);
+    compress(h_, tail, n);
+    digest_t out;
+    for (int i = 0; i < 5; ++i) {
+        detail::store_be32(out.data() + 4 * i, h_[i]);
+    }
+    reset();
+    return out;
+}
+
+sha1::digest_t sha1::hash(const void* data, size_t len) {
+    sha1 h;
+    h.update(data, len);
+    return h.digest();
+}
+
+void sha1_batch(const std::string_view* msgs, size_t n, sha1::digest_t* out) {
+    if (LC_SHA_NI && N32 < 16) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = sha1::hash(msgs[i].data(), msgs[i].size());
+        }
+        return;
+    }
+    detail::hash_lanes<lanes160>(msgs, n, out, IV);
+}
+
+std::string sha1_base64(const char* data, size_t len) {
+    // the base64 kernel reads around its input
+    HWY_ALIGN uint8_t buf[64 + sha1::kDigestSize + 64] = {0};
+    const auto d = sha1::hash(data, len);
+    memcpy(buf + 64, d.data(), d.size());
+    std::string out((sha1::kDigestSize + 2) / 3 * 4, '\0');
+    detail::base64_encode_to((const char*)buf + 64, d.size(), out.data(), false);
+    return out;
+}
+
+}  // namespace lc
@@ -0,0 +1,216 @@
+#include "lcrypt/sha256.h"
+#include "detail/sha256.h"
+#include "detail/hwy.h"
+#include "detail/multibuffer.h"
+#include <string.h>
+#if defined(__SHA__) && defined(__SSE4_1__)
+#include <immintrin.h>
+#define LC_SHA_NI 1
+#else
+#define LC_SHA_NI 0
+#endif
+
+namespace {
+
+using lc::detail::load_be32;
+
+HWY_ALIGN constexpr uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+constexpr uint32_t IV[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                            0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+inline uint32_t rotr(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+void compress_scalar(uint32_t* h, const uint8_t* p, size_t blocks) {
+    for (; blocks != 0; --blocks, p += 64) {
+        uint32_t w[64];
+        for (int t = 0; t < 16; ++t) {
+            w[t] = load_be32(p + 4 * t);
+        }
+        for (int t = 16; t < 64; ++t) {
+            const uint32_t s0 = rotr(w[t - 15], 7) ^ rotr(w[t - 15], 18) ^ (w[t - 15] >> 3);
+            const uint32_t s1 = rotr(w[t - 2], 17) ^ rotr(w[t - 2], 19) ^ (w[t - 2] >> 10);
+            w[t]              = w[t - 16] + s0 + w[t - 7] + s1;
+        }
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], k = h[7];
+        for (int t = 0; t < 64; ++t) {
+            const uint32_t t1 =
+                k + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[t] + w[t];
+            const uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            k = g, g = f, f = e, e = d + t1;
+            d = c, c = b, b = a, a = t1 + t2;
+        }
+        h[0] += a, h[1] += b, h[2] += c, h[3] += d, h[4] += e, h[5] += f, h[6] += g, h[7] += k;
+    }
+}
+
+#if LC_SHA_NI
+/// The state is kept as ABEF / CDGH, two rounds per sha256rnds2
+void compress_shani(uint32_t* h, const uint8_t* p, size_t blocks) {
+    const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i t          = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)h), 0xb1);
+    __m128i s1         = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(h + 4)), 0x1b);
+    __m128i s0         = _mm_alignr_epi8(t, s1, 8);
+    s1                 = _mm_blend_epi16(s1, t, 0xf0);
+
+    for (; blocks != 0; --blocks, p += 64) {
+        const __m128i abef = s0, cdgh = s1;
+        __m128i m[4];
+        for (int i = 0; i < 16; ++i) {
+            if (i < 4) {
+                m[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(p + 16 * i)), mask);
+            }
+            const __m128i cur = m[i & 3];
+            __m128i x         = _mm_add_epi32(cur, _mm_load_si128((const __m128i*)(K + 4 * i)));
+            s1                = _mm_sha256rnds2_epu32(s1, s0, x);
+            if (i >= 3 && i <= 14) {
+                __m128i& nx = m[(i + 1) & 3];
+                nx          = _mm_add_epi32(nx, _mm_alignr_epi8(cur, m[(i + 3) & 3], 4));
+                nx          = _mm_sha256msg2_epu32(nx, cur);
+            }
+            x  = _mm_shuffle_epi32(x, 0x0e);
+            s0 = _mm_sha256rnds2_epu32(s0, s1, x);
+            if (i >= 1 && i <= 12) {
+                m[(i + 3) & 3] = _mm_sha256msg1_epu32(m[(i + 3) & 3], cur);
+            }
+        }
+        s0 = _mm_add_epi32(s0, abef);
+        s1 = _mm_add_epi32(s1, cdgh);
+    }
+
+    t  = _mm_shuffle_epi32(s0, 0x1b);
+    s1 = _mm_shuffle_epi32(s1, 0xb1);
+    s0 = _mm_blend_epi16(t, s1, 0xf0);
+    s1 = _mm_alignr_epi8(s1, t, 8);
+    _mm_storeu_si128((__m128i*)h, s0);
+    _mm_storeu_si128((__m128i*)(h + 4), s1);
+}
+#endif
+
+inline void compress(uint32_t* h, const uint8_t* p, size_t blocks) {
+#if LC_SHA_NI
+    compress_shani(h, p, blocks);
+#else
+    compress_scalar(h, p, blocks);
+#endif
+}
+
+/// SHA-256 over a message per u32 lane, for detail::hash_lanes
+struct lanes256 {
+    static constexpr size_t kWords      = 8;
+    static constexpr size_t kDigestSize = 32;
+    static constexpr bool kBigEndian    = true;
+
+    template <class D, class V = hn::Vec<D>>
+    static void compress(D d, V* h, const V* m) {
+        V w[16];
+        for (int t = 0; t < 16; ++t) {
+            w[t] = m[t];
+        }
+        V a = h[0], b = h[1], c = h[2], e = h[4], f = h[5], g = h[6];
+        V dd = h[3], k = h[7];
+        for (int t = 0; t < 64; ++t) {
+            if (t >= 16) {
+                const V w15 = w[(t - 15) & 15], w2 = w[(t - 2) & 15];
+                const V s0  = hn::Xor3(hn::RotateRight<7>(w15), hn::RotateRight<18>(w15),
+                                       hn::ShiftRight<3>(w15));
+                const V s1  = hn::Xor3(hn::RotateRight<17>(w2), hn::RotateRight<19>(w2),
+                                       hn::ShiftRight<10>(w2));
+                w[t & 15]   = hn::Add(hn::Add(w[t & 15], s0), hn::Add(w[(t - 7) & 15], s1));
+            }
+            const V S1 =
+                hn::Xor3(hn::RotateRight<6>(e), hn::RotateRight<11>(e), hn::RotateRight<25>(e));
+            const V ch = hn::Xor(hn::And(e, f), hn::AndNot(e, g));
+            const V t1 = hn::Add(hn::Add(hn::Add(k, S1), hn::Add(ch, w[t & 15])), hn::Set(d, K[t]));
+            const V S0 =
+                hn::Xor3(hn::RotateRight<2>(a), hn::RotateRight<13>(a), hn::RotateRight<22>(a));
+            const V maj = hn::Or(hn::And(a, b), hn::And(c, hn::Or(a, b)));
+            k           = g;
+            g           = f;
+            f           = e;
+            e           = hn::Add(dd, t1);
+            dd          = c;
+            c           = b;
+            b           = a;
+            a           = hn::Add(t1, hn::Add(S0, maj));
+        }
+        h[0] = hn::Add(h[0], a);
+        h[1] = hn::Add(h[1], b);
+        h[2] = hn::Add(h[2], c);
+        h[3] = hn::Add(h[3], dd);
+        h[4] = hn::Add(h[4], e);
+        h[5] = hn::Add(h[5], f);
+        h[6] = hn::Add(h[6], g);
+        h[7] = hn::Add(h[7], k);
+    }
+};
+
+}  // namespace
+
+namespace lc {
+
+sha256::sha256(const uint32_t* h, uint64_t len) : len_(len) {
+    memcpy(h_, h, sizeof(h_));
+}
+
+void sha256::reset() {
+    memcpy(h_, IV, sizeof(h_));
+    len_ = 0;
+}
+
+sha256& sha256::update(const void* data, size_t len) {
+    detail::md_update(buf_, len_, (const uint8_t*)data, len,
+                      [this](const uint8_t* p, size_t blocks) { compress(h_, p, blocks); });
+    return *this;
+}
+
+sha256::digest_t sha256::digest() {
+    uint8_t tail[2 * kBlockSize];
+    const size_t n = detail::md_pad(tail, buf_, len_, 0, true);
+    compress(h_, tail, n);
+    digest_t out;
+    for (int i = 0; i < 8; ++i) {
+        detail::store_be32(out.data() + 4 * i, h_[i]);
+    }
+    reset();
+    return out;
+}
+
+sha256::digest_t sha256::hash(const void* data, size_t len) {
+    sha256 h;
+    h.update(data, len);
+    return h.digest();
+}
+
+void sha256_batch(const std::string_view* msgs, size_t n, sha256::digest_t* out) {
+    detail::sha256_batch(msgs, n, out, IV, 0);
+}
+
+void detail::sha256_batch(const std::string_view* msgs, size_t n, sha256::digest_t* out,
+                          const uint32_t* iv, uint64_t prefix) {
+    if (LC_SHA_NI && N32 < 16) {
+        for (size_t i = 0; i < n; ++i) {
+            sha256 h(iv, prefix);
+            out[i] = h.update(msgs[i].data(), msgs[i].size()).digest();
+        }
+        return;
+    }
+    detail::hash_lanes<lanes256>(msgs, n, out, iv, prefix);
+}
+
+void detail::sha256_compress(uint32_t* h, const uint8_t* p, size_t blocks) {
+    compress(h, p, blocks);
+}
+
+}  // namespace lc
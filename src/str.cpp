@@ -1,3 +1,5 @@
+#include "detail/hwy.h"
+#include "detail/utf8.h"
 #include <algorithm>
 #include <stdexcept>
 #include <hwy/contrib/unroller/unroller-inl.h>
@@ -9,10 +11,6 @@
 
 namespace hn = hwy::HWY_NAMESPACE;
 
-static HWY_FULL(uint8_t) _du8;
-using vec8_t               = hn::Vec<decltype(_du8)>;
-static constexpr size_t N8 = hn::Lanes(_du8);
-
 #define MAX_SIZET ((size_t)(~(size_t)0))
 
 #define MAXSIZE (sizeof(size_t) < sizeof(int) ? MAX_SIZET : (size_t)(INT_MAX))
@@ -36,11 +34,15 @@ struct UpperUnit : hn::UnrollerUnit<UpperUnit, uint8_t, uint8_t> {
     const hn::Vec<TT> _0x7a = hn::Set(_d, 0x7a);
     const hn::Vec<TT> _32   = hn::Set(_d, 32);
 
+    hn::Vec<TT> Fold(const hn::Vec<TT> xx) const {
+        auto m = hn::And(hn::Ge(xx, _0x61), hn::Le(xx, _0x7a));
+        return hn::IfThenElse(m, hn::Sub(xx, _32), xx);
+    }
+
     hn::Vec<TT> Func(ptrdiff_t idx, const hn::Vec<TT> xx, const hn::Vec<TT> yy) {
         (void)idx;
         (void)yy;
-        auto m = hn::And(hn::Ge(xx, _0x61), hn::Le(xx, _0x7a));
-        return hn::IfThenElse(m, hn::Sub(xx, _32), xx);
+        return Fold(xx);
     }
 };
 
@@ -51,14 +53,100 @@ struct LowerUnit : hn::UnrollerUnit<LowerUnit, uint8_t, uint8_t> {
     const hn::Vec<TT> _0x5a = hn::Set(_d, 0x5a);
     const hn::Vec<TT> _32   = hn::Set(_d, 32);
 
+    hn::Vec<TT> Fold(const hn::Vec<TT> xx) const {
+        auto m = hn::And(hn::Ge(xx, _0x41), hn::Le(xx, _0x5a));
+        return hn::IfThenElse(m, hn::Add(xx, _32), xx);
+    }
+
     hn::Vec<TT> Func(ptrdiff_t idx, const hn::Vec<TT> xx, const hn::Vec<TT> yy) {
         (void)idx;
         (void)yy;
-        auto m = hn::And(hn::Ge(xx, _0x41), hn::Le(xx, _0x5a));
-        return hn::IfThenElse(m, hn::Add(xx, _32), xx);
+        return Fold(xx);
+    }
+};
+
+// refer:
+// https://github.com/simdjson/simdjson/blob/master/src/generic/stage1/utf8_lookup4_algorithm.h
+struct Utf8Checker {
+    using TT = hn::ScalableTag<uint8_t>;
+    inline static constexpr TT _d{};
+
+    enum : uint8_t {
+        TOO_SHORT      = 1 << 0,  // 11______ 0_______, 11______ 11______
+        TOO_LONG       = 1 << 1,  // 0_______ 10______
+        OVERLONG_3     = 1 << 2,  // 11100000 100_____
+        TOO_LARGE      = 1 << 3,  // 11110100 1001____, 11110101 ...
+        SURROGATE      = 1 << 4,  // 11101101 101_____
+        OVERLONG_2     = 1 << 5,  // 1100000_ 10______
+        TOO_LARGE_1000 = 1 << 6,  // 11110101 1000____ ...
+        OVERLONG_4     = 1 << 6,  // 11110000 1000____
+        TWO_CONTS      = 1 << 7,  // 10______ 10______
+        CARRY          = TOO_SHORT | TOO_LONG | TWO_CONTS,
+    };
+
+    // clang-format off
+    const hn::Vec<TT> _byte_1_high = hn::Dup128VecFromValues(_d,
+        TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+        TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+        TOO_SHORT | OVERLONG_2,
+        TOO_SHORT,
+        TOO_SHORT | OVERLONG_3 | SURROGATE,
+        TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4);
+    const hn::Vec<TT> _byte_1_low = hn::Dup128VecFromValues(_d,
+        CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+        CARRY | OVERLONG_2,
+        CARRY,
+        CARRY,
+        CARRY | TOO_LARGE,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000);
+    const hn::Vec<TT> _byte_2_high = hn::Dup128VecFromValues(_d,
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT);
+    // clang-format on
+    const hn::Vec<TT> _0x0f = hn::Set(_d, 0x0f);
+    const hn::Vec<TT> _0x60 = hn::Set(_d, 0xe0 - 0x80);
+    const hn::Vec<TT> _0x70 = hn::Set(_d, 0xf0 - 0x80);
+    const hn::Vec<TT> _0x80 = hn::Set(_d, 0x80);
+
+    /// `pN` are the same bytes as `in` shifted back by N positions.
+    /// Returns true if any lane is invalid.
+    bool Check(const hn::Vec<TT> p3, const hn::Vec<TT> p2, const hn::Vec<TT> p1,
+               const hn::Vec<TT> in) const {
+        const auto b1h = hn::TableLookupBytes(_byte_1_high, hn::ShiftRight<4>(p1));
+        const auto b1l = hn::TableLookupBytes(_byte_1_low, hn::And(p1, _0x0f));
+        const auto b2h = hn::TableLookupBytes(_byte_2_high, hn::ShiftRight<4>(in));
+        const auto sc  = hn::And(hn::And(b1h, b1l), b2h);
+        // prev2 >= 0xe0 or prev3 >= 0xf0 means `in` must be a continuation byte
+        const auto must23 = hn::Or(hn::SaturatedSub(p2, _0x60), hn::SaturatedSub(p3, _0x70));
+        const auto err    = hn::Xor(hn::And(must23, _0x80), sc);
+        return !hn::AllTrue(_d, hn::Eq(err, hn::Zero(_d)));
     }
 };
 
+inline size_t utf8_validate_scalar(const uint8_t* p, size_t len, size_t start) {
+    uint32_t cp;
+    for (size_t i = start; i < len;) {
+        int n = utf8_decode(p + i, len - i, cp);
+        if (n == 0) return i;
+        i += n;
+    }
+    return std::string_view::npos;
+}
+
 inline int mcmp(const void* s1, const void* s2, size_t n) {
 #if HWY_COMPILER_MSVC
     return memcmp(s1, s2, n);
@@ -67,6 +155,87 @@ inline int mcmp(const void* s1, const void* s2, size_t n) {
 #endif
 }
 
+inline uint64_t bswap64(uint64_t x) {
+#if HWY_COMPILER_MSVC
+    return _byteswap_uint64(x);
+#else
+    return __builtin_bswap64(x);
+#endif
+}
+
+/// Reverses the bytes of the `n` lanes at p
+template <class D, typename T = hn::TFromD<D>>
+void bswap_lanes(D d, T* p, size_t n) {
+    const size_t N = hn::Lanes(d);
+    size_t i       = 0;
+    for (; i + N <= n; i += N) {
+        hn::StoreU(hn::ReverseLaneBytes(hn::LoadU(d, p + i)), d, p + i);
+    }
+    if (i != n) {
+        hn::StoreN(hn::ReverseLaneBytes(hn::LoadN(d, p + i, n - i)), d, p + i, n - i);
+    }
+}
+
+inline void bswap_lanes(char* p, size_t n, size_t w) {
+    switch (w) {
+    case 2: bswap_lanes(_du16, (uint16_t*)p, n); break;
+    case 4: bswap_lanes(_du32, (uint32_t*)p, n); break;
+    case 8: bswap_lanes(HWY_FULL(uint64_t)(), (uint64_t*)p, n); break;
+    default: break;
+    }
+}
+
+/// p[i * stride] -> out[i * W]
+template <size_t W>
+void gather(const char* p, size_t stride, size_t n, char* out) {
+    for (size_t i = 0; i < n; ++i) {
+        memcpy(out + i * W, p + i * stride, W);
+    }
+}
+
+/// in[i * W] -> p[i * stride]
+template <size_t W>
+void scatter(const char* in, size_t n, char* p, size_t stride) {
+    for (size_t i = 0; i < n; ++i) {
+        memcpy(p + i * stride, in + i * W, W);
+    }
+}
+
+/// case-insensitive compare of `len` bytes
+inline bool imcmp(const uint8_t* a, const uint8_t* b, size_t len) {
+    LowerUnit lowerfn;
+    size_t i = 0;
+    for (; i + N8 <= len; i += N8) {
+        const auto xa = lowerfn.Fold(hn::LoadU(_du8, a + i));
+        const auto xb = lowerfn.Fold(hn::LoadU(_du8, b + i));
+        if (!hn::AllTrue(_du8, hn::Eq(xa, xb))) return false;
+    }
+    if (i < len) {
+        // LoadN zero-fills the missing lanes on both sides
+        const auto xa = lowerfn.Fold(hn::LoadN(_du8, a + i, len - i));
+        const auto xb = lowerfn.Fold(hn::LoadN(_du8, b + i, len - i));
+        return hn::AllTrue(_du8, hn::Eq(xa, xb));
+    }
+    return true;
+}
+
+inline uint64_t hash_mix(uint64_t h, uint64_t w) {
+    w *= 0x87c37b91114253d5ULL;
+    w = (w << 31) | (w >> 33);
+    h ^= w * 0x4cf5ad432745937fULL;
+    h = (h << 27) | (h >> 37);
+    return h * 5 + 0x52dce729;
+}
+
+inline uint64_t hash_final(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
 }  // namespace detail
 
 namespace detail {
@@ -75,6 +244,27 @@ static inline int isdigit(int c) {
     return '0' <= c && c <= '9';
 }
 
+size_t find_nul(const char* s, size_t len) {
+    const u8* p    = (const u8*)s;
+    const vu8 zero = hn::Zero(_du8);
+    size_t i       = 0;
+    for (; i + N8 <= len; i += N8) {
+        const intptr_t b = hn::FindFirstTrue(_du8, hn::Eq(hn::LoadU(_du8, p + i), zero));
+        if (b >= 0) {
+            return i + b;
+        }
+    }
+    if (i < len) {
+        const size_t n   = len - i;
+        const auto m     = hn::And(hn::Eq(hn::LoadN(_du8, p + i, n), zero), hn::FirstN(_du8, n));
+        const intptr_t b = hn::FindFirstTrue(_du8, m);
+        if (b >= 0) {
+            return i + b;
+        }
+    }
+    return len;
+}
+
 PackFmtParser::PackFmtParser(std::string_view fmt)
   : fmt_(fmt)
   , count_(fmt.size())
@@ -94,6 +284,7 @@ void PackFmtParser::nextop(option_t& op) {
     // clang-format on
     op.islittle = islittle_;
     op.ntoalign = 0;
+    op.align    = 1;
     op.size     = 0;
     op.op       = Knop;
 
@@ -115,6 +306,9 @@ void PackFmtParser::nextop(option_t& op) {
         case 'I': op.size = getnum_from_current(sizeof(int)); op.op = Kuint; break;
         case 's': op.size = getnum_from_current(sizeof(size_t)); op.op = Kstring; break;
         case 'z': op.op = Kzstr; break;
+        case 'V': op.op = Kvarint; break;
+        case 'v': op.op = Kzigzag; break;
+        case 'S': op.op = Kvstring; break;
         case 'x': op.size = 1; op.op = Kpadding; break;
         case 'c':
             op.size = getnum_from_current(-1);
@@ -159,6 +353,7 @@ void PackFmtParser::nextop(option_t& op) {
         if ((align & (align - 1)) != 0) {
             throw std::runtime_error("format asks for alignment not power of 2");
         }
+        op.align    = HWY_MAX(align, 1);
         op.ntoalign = (align - (int)(totalsize_ & (align - 1))) & (align - 1);
     }
     // fprintf(stderr, "op: %d - %d - %d - %d - totalsize: %d\n", op.islittle, op.op, op.size,
@@ -178,11 +373,26 @@ int PackFmtParser::getnum_from_current(int df) {
 }
 
 void PackFmtParser::packint(buffer_t& b, uint64_t n, const option_t& op, int neg) {
-    auto islittle = op.islittle;
-    auto size     = op.size;
-    int i;
+    b.resize(b.size() + op.size);
+    writeint(&b.back() + 1 - op.size, {op.op, (uint32_t)op.size, (uint32_t)op.align, op.islittle}, n,
+             neg);
+}
+
+size_t PackFmtParser::packvarint(buffer_t& b, uint64_t n) {
+    const size_t size = varint_size(n);
     b.resize(b.size() + size);
-    char* buff                    = &b.back() + 1 - size;
+    return varint_write(&b.back() + 1 - size, n);
+}
+
+void PackFmtParser::writeint(char* buff, const PackOp& op, uint64_t n, int neg) {
+    const int islittle = op.islittle;
+    const int size     = op.size;
+    int i;
+    if (size <= SZINT && islittle == HWY_IS_LITTLE_ENDIAN) {
+        // the low `size` bytes in host order
+        hwy::CopyBytes((const char*)&n + (HWY_IS_LITTLE_ENDIAN ? 0 : SZINT - size), buff, size);
+        return;
+    }
     buff[islittle ? 0 : size - 1] = (char)(n & MC);
     for (i = 1; i < size; i++) {
         n >>= NB;
@@ -196,14 +406,168 @@ void PackFmtParser::packint(buffer_t& b, uint64_t n, const option_t& op, int neg
     }
 }
 
+void PackFmtParser::writefloat(char* out, const PackOp& op, double v) {
+    char buf[sizeof(double)];
+    if (op.op == Kfloat) {
+        float f = (float)v;
+        hwy::CopyBytes(&f, buf, sizeof(f));
+    } else {
+        hwy::CopyBytes(&v, buf, sizeof(v));
+    }
+    if (op.islittle == HWY_IS_LITTLE_ENDIAN) {
+        hwy::CopyBytes(buf, out, op.size);
+    } else {
+        for (size_t i = 0; i < op.size; i++) {
+            out[i] = buf[op.size - 1 - i];
+        }
+    }
+}
+
+size_t PackFmtParser::writestr(char* out, const PackOp& op, std::string_view v) {
+    switch (op.op) {
+    case Kchar: { /* fixed-size string */
+        if (v.size() > op.size) {
+            throw std::runtime_error("cn: string longer than given size");
+        }
+        hwy::CopyBytes(v.data(), out, v.size());
+        memset(out + v.size(), PACKPADBYTE, op.size - v.size());
+        return op.size;
+    }
+    case Kstring: { /* strings with length count */
+        writeint(out, op, (uint64_t)v.size(), 0);
+        hwy::CopyBytes(v.data(), out + op.size, v.size());
+        return op.size + v.size();
+    }
+    case Kzstr: { /* zero-terminated string */
+        hwy::CopyBytes(v.data(), out, v.size());
+        out[v.size()] = '\0';
+        return v.size() + 1;
+    }
+    case Kvstring: {
+        const size_t n = varint_write(out, v.size());
+        hwy::CopyBytes(v.data(), out + n, v.size());
+        return n + v.size();
+    }
+    default: std::rethrow_exception(make_error("string", op.op)); break;
+    }
+    return 0;
+}
+
+double PackFmtParser::readfloat(const char* p, const PackOp& op) {
+    char buf[sizeof(double)];
+    if (op.islittle == HWY_IS_LITTLE_ENDIAN) {
+        hwy::CopyBytes(p, buf, op.size);
+    } else {
+        for (size_t i = 0; i < op.size; ++i) {
+            buf[i] = p[op.size - 1 - i];
+        }
+    }
+    if (op.op == Kfloat) {
+        float f;
+        hwy::CopyBytes(buf, &f, sizeof(f));
+        return f;
+    }
+    double d;
+    hwy::CopyBytes(buf, &d, sizeof(d));
+    return d;
+}
+
+void PackFmtParser::readcolumn(const char* src, size_t stride, size_t n, const PackOp& op,
+                              void* out) {
+    char* o        = (char*)out;
+    const size_t w = pack_lanesize(op);
+    if (op.size != w) { /* 3, 5, 6, 7 and wider than 8 byte integers */
+        for (size_t i = 0; i < n; ++i) {
+            const int64_t v =
+                unpackint(std::string_view(src + i * stride, op.size), op.islittle, op.op == Kint);
+            memcpy(o + i * w, &v, w);
+        }
+        return;
+    }
+    if (stride == w) {
+        memcpy(o, src, n * w);
+    } else {
+        switch (w) {
+        case 1: gather<1>(src, stride, n, o); break;
+        case 2: gather<2>(src, stride, n, o); break;
+        case 4: gather<4>(src, stride, n, o); break;
+        default: gather<8>(src, stride, n, o); break;
+        }
+    }
+    if (op.islittle != HWY_IS_LITTLE_ENDIAN) {
+        bswap_lanes(o, n, w);
+    }
+}
+
+void PackFmtParser::writecolumn(char* dst, size_t stride, size_t n, const PackOp& op,
+                               const void* in) {
+    const char* p  = (const char*)in;
+    const size_t w = pack_lanesize(op);
+    if (op.size != w) {
+        for (size_t i = 0; i < n; ++i) {
+            int64_t v;
+            memcpy(&v, p + i * w, w);
+            writeint(dst + i * stride, op, (uint64_t)v, op.op == Kint && v < 0);
+        }
+        return;
+    }
+    const bool swap = w != 1 && op.islittle != HWY_IS_LITTLE_ENDIAN;
+    if (stride == w) {
+        memcpy(dst, p, n * w);
+        if (swap) {
+            bswap_lanes(dst, n, w);
+        }
+        return;
+    }
+    HWY_ALIGN char tmp[512];
+    const size_t block = swap ? sizeof(tmp) / w : n;
+    for (size_t b = 0; b < n; b += block) {
+        const size_t m  = HWY_MIN(block, n - b);
+        const char* src = p + b * w;
+        if (swap) {
+            memcpy(tmp, src, m * w);
+            bswap_lanes(tmp, m, w);
+            src = tmp;
+        }
+        switch (w) {
+        case 1: scatter<1>(src, m, dst + b * stride, stride); break;
+        case 2: scatter<2>(src, m, dst + b * stride, stride); break;
+        case 4: scatter<4>(src, m, dst + b * stride, stride); break;
+        default: scatter<8>(src, m, dst + b * stride, stride); break;
+        }
+    }
+}
+
+bool PackOpParser::next(PackOp& op) {
+    PackFmtParser::option_t o;
+    do {
+        pfp_.nextop(o);
+    } while (o.op == Knop);
+    if (o.op == Kend) {
+        return false;
+    }
+    op = {o.op, (uint32_t)o.size, (uint32_t)o.align, o.islittle};
+    return true;
+}
+
 int64_t PackFmtParser::unpackint(std::string_view s, int islittle, int issigned) {
     uint64_t res = 0;
     int i;
     size_t size = s.size();
     int limit   = (size <= SZINT) ? size : SZINT;
-    for (i = limit - 1; i >= 0; i--) {
-        res <<= NB;
-        res |= (uint64_t)(uint8_t)s[islittle ? i : size - 1 - i];
+    if (size != 0 && size <= SZINT) {
+        // one load, the bytes land at the low end in host order
+        if (islittle == HWY_IS_LITTLE_ENDIAN) {
+            memcpy((char*)&res + (HWY_IS_LITTLE_ENDIAN ? 0 : SZINT - size), s.data(), size);
+        } else {
+            memcpy((char*)&res + (HWY_IS_LITTLE_ENDIAN ? SZINT - size : 0), s.data(), size);
+            res = bswap64(res);
+        }
+    } else {
+        for (i = limit - 1; i >= 0; i--) {
+            res <<= NB;
+            res |= (uint64_t)(uint8_t)s[islittle ? i : size - 1 - i];
+        }
     }
     if (size < SZINT) { /* real size smaller than lua_Integer? */
         if (issigned) { /* needs sign extension? */
@@ -274,32 +638,57 @@ void PackFmtParser::packone(buffer_t& b, const option_t& op, std::string_view v)
         add_size(v.size() + 1);
         break;
     }
+    case Kvstring: { /* strings with a varint length */
+        add_size(packvarint(b, v.size()) + v.size());
+        b.insert(b.end(), v.begin(), v.end());
+        break;
+    }
     default: std::rethrow_exception(make_error("string", op.op)); break;
     }
 }
 
-void PackFmtParser::unpackone(std::string& v, int& consumed, std::string_view s, const option_t& op) {
+void PackFmtParser::unpackone(std::string_view& v, int& consumed, std::string_view s,
+                              const option_t& op) {
+    // a short `s` yields consumed > s.size(), which str_unpack reports as overflow
     switch (op.op) {
     case Kchar:
-        v.append(s.data(), op.size);
+        v        = s.substr(0, op.size);
         consumed = op.size;
         break;
     case Kstring: {
-        auto len = (size_t)unpackint(s.substr(0, op.size), op.islittle, 0);
-        v.append(s.data() + op.size, len);
-        consumed = op.size + len;
+        const size_t head = HWY_MIN(op.size, s.size());
+        auto len          = (size_t)unpackint(s.substr(0, head), op.islittle, 0);
+        v                 = s.substr(head, len);
+        consumed          = op.size + len;
         break;
     }
     case Kzstr: {
-        auto len = strlen(s.data());
-        v.append(s.data(), len);
+        auto len = find_nul(s.data(), s.size());
+        v        = s.substr(0, len);
         consumed = len + 1;
         break;
     }
+    case Kvstring: {
+        uint64_t len;
+        const size_t n = varint_read(s.data(), s.size(), len);
+        if (n == 0 || len > s.size() - n) {
+            consumed = (int)s.size() + 1;
+            break;
+        }
+        v        = s.substr(n, len);
+        consumed = (int)(n + len);
+        break;
+    }
     default: std::rethrow_exception(make_error("string", op.op)); break;
     }
 }
 
+void PackFmtParser::unpackone(std::string& v, int& consumed, std::string_view s, const option_t& op) {
+    std::string_view sv;
+    unpackone(sv, consumed, s, op);
+    v.append(sv.data(), sv.size());
+}
+
 std::string PackFmtParser::to_string(KOption op) {
     switch (op) {
     case Kint: return "int";
@@ -309,6 +698,9 @@ std::string PackFmtParser::to_string(KOption op) {
     case Kchar: return "charn";
     case Kstring: return "string";
     case Kzstr: return "zstr";
+    case Kvarint: return "varint";
+    case Kzigzag: return "zigzag";
+    case Kvstring: return "vstring";
     case Kpadding: return "padding";
     case Kpaddalign: return "paddalign";
     case Knop: return "nop";
@@ -318,14 +710,524 @@ std::string PackFmtParser::to_string(KOption op) {
 }
 
 std::exception_ptr PackFmtParser::make_error(std::string_view tname, KOption op) {
-    char buf[64] = {0};
-    auto n       = snprintf(buf, 64, "Type dismatch(%s, %s)", std::string(tname).c_str(),
-                            to_string(op).c_str());
-    return std::make_exception_ptr(std::runtime_error(std::string(buf, n)));
+    std::string msg("Type dismatch(");
+    msg.append(tname).append(", ").append(to_string(op)).append(")");
+    return std::make_exception_ptr(std::runtime_error(msg));
 }
 
 }  // namespace detail
 
+// pack_format
+
+pack_format::pack_format(std::string_view fmt) : recsize_(0) {
+    detail::PackOpParser parser(fmt);
+    detail::PackOp op;
+    while (parser.next(op)) {
+        ops_.push_back(op);
+    }
+
+    // record layout for the *_array functions
+    for (const auto& o : ops_) {
+        recsize_ += detail::pack_ntoalign(recsize_, o.align);
+        if (!detail::pack_isfixed(o)) {
+            recsize_ = MAX_SIZET;
+            break;
+        }
+        if (o.op != detail::Kpadding && o.op != detail::Kpaddalign) {
+            fields_.push_back({o, recsize_});
+        }
+        recsize_ += o.size;
+    }
+}
+
+size_t pack_format::record_size() const {
+    if (recsize_ == MAX_SIZET) {
+        throw std::runtime_error("Array records need a fixed size, found 's', 'z', 'V', 'v' or 'S'");
+    }
+    return recsize_;
+}
+
+size_t pack_format::checkarray(size_t ncolumns) const {
+    const size_t n = record_size();
+    if (ncolumns < fields_.size()) {
+        throw std::runtime_error("Need params!!!");
+    }
+    if (ncolumns > fields_.size()) {
+        throw std::runtime_error("Too many params!!!");
+    }
+    return n;
+}
+
+size_t pack_format::unpackpad(std::string_view s, size_t& offset, size_t i) const {
+    for (; i < ops_.size(); ++i) {
+        const auto& op = ops_[i];
+        offset += detail::pack_ntoalign(offset, op.align);
+        if (op.op == detail::Kpadding) {
+            offset += 1;
+        } else if (op.op != detail::Kpaddalign) {
+            break;
+        }
+        check(offset, 0, s.size());
+    }
+    return i;
+}
+
+void pack_format::check(size_t offset, size_t need, size_t len) {
+    if (HWY_UNLIKELY(offset + need > len)) {
+        throw std::runtime_error(std::string("Data overflow. offset = ")
+                                 + std::to_string(offset + need) + ", len = " + std::to_string(len));
+    }
+}
+
+void pack_format::unpackone(std::string_view& v, size_t& offset, std::string_view s,
+                            const op_t& op) {
+    switch (op.op) {
+    case detail::Kchar:
+        check(offset, op.size, s.size());
+        v = s.substr(offset, op.size);
+        offset += op.size;
+        break;
+    case detail::Kstring: {
+        check(offset, op.size, s.size());
+        auto len = (size_t)detail::PackFmtParser::unpackint(s.substr(offset, op.size),
+                                                            op.islittle, 0);
+        offset += op.size;
+        check(offset, len, s.size());
+        v = s.substr(offset, len);
+        offset += len;
+        break;
+    }
+    case detail::Kzstr: {
+        const size_t len = detail::find_nul(s.data() + offset, s.size() - offset);
+        check(offset, len + 1, s.size());
+        v = s.substr(offset, len);
+        offset += len + 1;
+        break;
+    }
+    case detail::Kvstring: {
+        uint64_t len;
+        const size_t n = detail::varint_read(s.data() + offset, s.size() - offset, len);
+        check(offset, n ? n : s.size() - offset + 1, s.size());
+        offset += n;
+        check(offset, HWY_MIN(len, s.size() - offset + 1), s.size());
+        v = s.substr(offset, len);
+        offset += len;
+        break;
+    }
+    default: std::rethrow_exception(detail::PackFmtParser::make_error("string", op.op)); break;
+    }
+}
+
+void pack_format::unpackone(std::string& v, size_t& offset, std::string_view s, const op_t& op) {
+    std::string_view sv;
+    unpackone(sv, offset, s, op);
+    v.assign(sv.data(), sv.size());
+}
+
+void pack_format::unpackone(buffer_t& v, size_t& offset, std::string_view s, const op_t& op) {
+    std::string_view sv;
+    unpackone(sv, offset, s, op);
+    v.assign(sv.begin(), sv.end());
+}
+
+size_t unpack_values(const pack_format& fmt, std::string_view data, std::vector<pack_value>& out) {
+    const auto& ops = fmt.ops_;
+    out.resize(ops.size()); /* padding ops are dropped below */
+    size_t offset = 0;
+    size_t n      = 0;
+    for (size_t i = 0; (i = fmt.unpackpad(data, offset, i)) < ops.size();) {
+        const auto& op = ops[i++];
+        auto& v        = out[n++];
+        switch (op.op) {
+        case detail::Kint:
+        case detail::Kuint:
+        case detail::Kvarint:
+        case detail::Kzigzag:
+            v.type = pack_value::integer;
+            pack_format::unpackone(v.i, offset, data, op);
+            break;
+        case detail::Kfloat:
+        case detail::Kdouble:
+            v.type = pack_value::number;
+            pack_format::unpackone(v.d, offset, data, op);
+            break;
+        default: {
+            std::string_view sv;
+            pack_format::unpackone(sv, offset, data, op);
+            v.type = pack_value::string;
+            v.s    = sv.data();
+            v.len  = sv.size();
+            break;
+        }
+        }
+    }
+    out.resize(n);
+    return offset;
+}
+
+// pack_reader
+
+void pack_reader::feed(std::string_view segment) {
+    if (!segment.empty()) {
+        segs_.push_back(segment);
+        fed_ += segment.size();
+    }
+}
+
+void pack_reader::feed(const std::string_view* segments, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        feed(segments[i]);
+    }
+}
+
+void pack_reader::advance(size_t n) {
+    cur_.pos += n;
+    cur_.off += n;
+    if (cur_.pos == segs_[cur_.seg].size()) {
+        cur_.seg++;
+        cur_.pos = 0;
+    }
+}
+
+bool pack_reader::read(char* out, size_t n) {
+    while (n != 0) {
+        if (cur_.seg == segs_.size()) {
+            missing_ = n;
+            return false;
+        }
+        const auto s   = segs_[cur_.seg];
+        const size_t k = HWY_MIN(n, s.size() - cur_.pos);
+        if (out) {
+            hwy::CopyBytes(s.data() + cur_.pos, out, k);
+            out += k;
+        }
+        n -= k;
+        advance(k);
+    }
+    return true;
+}
+
+bool pack_reader::view(size_t n, std::string_view& v) {
+    if (cur_.seg < segs_.size() && segs_[cur_.seg].size() - cur_.pos >= n) {
+        v = segs_[cur_.seg].substr(cur_.pos, n);
+        advance(n);
+        return true;
+    }
+    if (n == 0) {
+        v = {};
+        return true;
+    }
+    auto& s = scratch_.emplace_back(n, '\0');
+    v       = s;
+    return read(s.data(), n);
+}
+
+bool pack_reader::zlen(size_t& n) {
+    size_t total = 0;
+    size_t pos   = cur_.pos;
+    for (size_t i = cur_.seg; i < segs_.size(); ++i, pos = 0) {
+        const auto s   = segs_[i];
+        const size_t k = detail::find_nul(s.data() + pos, s.size() - pos);
+        if (k != s.size() - pos) {
+            n = total + k;
+            return true;
+        }
+        total += k;
+    }
+    missing_ = 1;
+    return false;
+}
+
+bool pack_reader::varint(char* out, size_t& n) {
+    for (n = 0; n < 10;) {
+        if (cur_.seg == segs_.size()) {
+            missing_ = 1;
+            return false;
+        }
+        const char c = segs_[cur_.seg][cur_.pos];
+        advance(1);
+        out[n++] = c;
+        if ((uint8_t)c < 0x80) {
+            break;
+        }
+    }
+    return true;
+}
+
+bool pack_reader::unpackpad(size_t& i, size_t& offset) {
+    const auto& ops = fmt_.ops_;
+    for (; i < ops.size(); ++i) {
+        const auto& op = ops[i];
+        const size_t n = detail::pack_ntoalign(offset, op.align) + (op.op == detail::Kpadding);
+        if (!read(nullptr, n)) {
+            return false;
+        }
+        offset += n;
+        if (op.op != detail::Kpadding && op.op != detail::Kpaddalign) {
+            break;
+        }
+    }
+    return true;
+}
+
+// varint
+
+namespace {
+
+inline uint64_t loadle64(const uint8_t* p) {
+    uint64_t w;
+    memcpy(&w, p, 8);
+    return HWY_IS_LITTLE_ENDIAN ? w : detail::bswap64(w);
+}
+
+inline void storele64(char* p, uint64_t w) {
+    w = HWY_IS_LITTLE_ENDIAN ? w : detail::bswap64(w);
+    memcpy(p, &w, 8);
+}
+
+/// Packs the low 7 bits of the 8 bytes of x
+inline uint64_t varint_compact(uint64_t x) {
+    x &= 0x7f7f7f7f7f7f7f7full;
+    x = ((x & 0x7f007f007f007f00ull) >> 1) | (x & 0x007f007f007f007full);
+    x = ((x & 0x3fff00003fff0000ull) >> 2) | (x & 0x00003fff00003fffull);
+    return ((x & 0x0fffffff00000000ull) >> 4) | (x & 0x000000000fffffffull);
+}
+
+/// varint_compact() backwards, x < 2^56
+inline uint64_t varint_spread(uint64_t x) {
+    x = (x & 0x000000000fffffffull) | ((x & 0x00fffffff0000000ull) << 4);
+    x = (x & 0x00003fff00003fffull) | ((x & 0x0fffc0000fffc000ull) << 2);
+    return (x & 0x007f007f007f007full) | ((x & 0x3f803f803f803f80ull) << 1);
+}
+
+/// Decodes the varint at p[0] with 16 bytes readable, `i` is its offset in the input.
+/// The continuation bits of 8 bytes are tested at once, returns the size.
+inline size_t varint_decode1(const uint8_t* p, size_t i, uint64_t& v) {
+    const uint64_t w    = loadle64(p);
+    const uint64_t stop = ~w & 0x8080808080808080ull;
+    if (HWY_LIKELY(stop != 0)) {
+        const size_t bits = hwy::Num0BitsBelowLS1Bit_Nonzero64(stop) + 1;
+        v                 = varint_compact(bits == 64 ? w : w & ((1ull << bits) - 1));
+        return bits / 8;
+    }
+    v = varint_compact(w) | ((uint64_t)(p[8] & 0x7f) << 56);
+    if (p[8] < 0x80) {
+        return 9;
+    }
+    if (HWY_UNLIKELY(p[9] > 1)) {
+        throw input_error(i + 9, p[9]);
+    }
+    v |= (uint64_t)p[9] << 63;
+    return 10;
+}
+
+/// Writes 8 bytes for values below 2^56, returns the size
+inline size_t varint_encode1(char* out, uint64_t x) {
+    if (HWY_LIKELY(x < (1ull << 56))) {
+        const size_t size   = (64 - hwy::Num0BitsAboveMS1Bit_Nonzero64(x | 1) + 6) / 7;
+        const uint64_t cont = ((1ull << (8 * (size - 1))) - 1) & 0x8080808080808080ull;
+        storele64(out, varint_spread(x) | cont);
+        return size;
+    }
+    return detail::varint_write(out, x);
+}
+
+inline auto varint_cont(vu8 v) {
+    return hn::Lt(hn::BitCast(_di8, v), hn::Zero(_di8));
+}
+
+/// A byte shuffle per continuation mask of 8 bytes. The varints of 1 or 2 bytes that start the
+/// window are spread into uint16 lanes, up to the first longer one or the one cut by the window.
+struct VarintShuffle {
+    uint8_t idx[16]; /* 0x80 is a zero byte */
+    uint8_t count;   /* varints */
+    uint8_t size;    /* bytes */
+};
+
+struct VarintShuffles {
+    VarintShuffle t[256] = {};
+
+    constexpr VarintShuffles() {
+        for (unsigned m = 0; m < 256; ++m) {
+            auto& e = t[m];
+            for (auto& x : e.idx) {
+                x = 0x80;
+            }
+            unsigned j = 0;
+            while (j < 8) {
+                if ((m >> j & 1) == 0) {
+                    e.idx[2 * e.count++] = (uint8_t)j;
+                    j += 1;
+                } else if (j < 7 && (m >> (j + 1) & 1) == 0) {
+                    e.idx[2 * e.count]       = (uint8_t)j;
+                    e.idx[2 * e.count++ + 1] = (uint8_t)(j + 1);
+                    j += 2;
+                } else {
+                    break;
+                }
+            }
+            e.size = (uint8_t)j;
+        }
+    }
+};
+
+constexpr VarintShuffles kVarintShuffles{};
+
+/// Decodes the varints of 1 or 2 bytes starting at p[0] with 16 bytes readable, the
+/// continuation bits of 8 bytes pick a shuffle. Returns the bytes read and adds to `k`.
+inline size_t varint_decode8(const uint8_t* p, uint64_t* out, size_t& k) {
+    const hn::FixedTag<uint8_t, 16> d16;
+    const hn::FixedTag<int8_t, 16> di16;
+    const hn::FixedTag<uint16_t, 8> dw;
+    const hn::CappedTag<uint64_t, 8> d64;
+    const hn::Rebind<uint16_t, decltype(d64)> dw64;
+    const size_t N64 = hn::Lanes(d64);
+
+    const auto x    = hn::LoadU(d16, p);
+    const auto cont = hn::Lt(hn::BitCast(di16, x), hn::Zero(di16));
+    const auto& s   = kVarintShuffles.t[MaskBits(di16, cont) & 0xff];
+    const auto w    = hn::BitCast(dw, hn::TableLookupBytesOr0(x, hn::LoadU(d16, s.idx)));
+    const auto v    = hn::Or(hn::And(w, hn::Set(dw, 0x7f)),
+                             hn::ShiftRight<1>(hn::And(w, hn::Set(dw, 0x7f00))));
+    HWY_ALIGN uint16_t lanes[8];
+    hn::Store(v, dw, lanes);
+    for (size_t j = 0; j < s.count; j += N64) {
+        const size_t n = s.count - j;
+        hn::StoreN(hn::PromoteTo(d64, hn::LoadN(dw64, lanes + j, n)), d64, out + k + j, n);
+    }
+    k += s.count;
+    return s.size;
+}
+
+}  // namespace
+
+size_t varint_count(std::string_view data) {
+    const uint8_t* p = (const uint8_t*)data.data();
+    const size_t len = data.size();
+    size_t i = 0, n = 0;
+    for (; i + N8 <= len; i += N8) {
+        n += N8 - hn::CountTrue(_di8, varint_cont(hn::LoadU(_du8, p + i)));
+    }
+    if (i != len) {
+        n += (len - i) - hn::CountTrue(_di8, varint_cont(hn::LoadN(_du8, p + i, len - i)));
+    }
+    return n;
+}
+
+size_t varint_decode(std::string_view data, uint64_t* out) {
+    const hn::ScalableTag<uint64_t> d64;
+    const hn::Rebind<uint8_t, decltype(d64)> d8;
+    const size_t N64 = hn::Lanes(d64);
+    const uint8_t* p = (const uint8_t*)data.data();
+    const size_t len = data.size();
+    size_t i = 0, k = 0;
+
+    while (i + N8 + 16 <= len) {
+        const auto cont = varint_cont(hn::LoadU(_du8, p + i));
+        if (hn::AllFalse(_di8, cont)) {
+            // N8 single byte varints
+            for (size_t j = 0; j < N8; j += N64) {
+                hn::StoreU(hn::PromoteTo(d64, hn::LoadU(d8, p + i + j)), d64, out + k + j);
+            }
+            i += N8;
+            k += N8;
+            continue;
+        }
+        const size_t stop = i + N8;
+        if (HWY_IS_LITTLE_ENDIAN
+            && hn::AllFalse(_di8, hn::And(cont, varint_cont(hn::LoadU(_du8, p + i + 1))))) {
+            // no two continuation bits in a row, varints of 1 or 2 bytes
+            while (i < stop) {
+                i += varint_decode8(p + i, out, k);
+            }
+            continue;
+        }
+        while (i < stop) {
+            uint64_t v;
+            i += varint_decode1(p + i, i, v);
+            out[k++] = v;
+        }
+    }
+
+    // tail, zero padded: a varint cut by the end stops one byte past it
+    HWY_ALIGN uint8_t buf[64 + 32] = {0};
+    const size_t base = i;
+    hwy::CopyBytes(p + base, buf, len - base);
+    while (i < len) {
+        uint64_t v;
+        i += varint_decode1(buf + i - base, i, v);
+        if (HWY_UNLIKELY(i > len)) {
+            throw input_error(len - 1, p[len - 1]);
+        }
+        out[k++] = v;
+    }
+    return k;
+}
+
+std::vector<uint64_t> varint_decode(std::string_view data) {
+    std::vector<uint64_t> r(varint_count(data));
+    varint_decode(data, r.data());
+    return r;
+}
+
+size_t varint_encode(const uint64_t* v, size_t n, char* out) {
+    const hn::ScalableTag<uint64_t> d64;
+    const hn::Rebind<uint8_t, decltype(d64)> d8;
+    const size_t N64 = hn::Lanes(d64);
+    size_t i = 0, pos = 0;
+    while (i + N64 <= n) {
+        const auto x = hn::LoadU(d64, v + i);
+        if (hn::AllTrue(d64, hn::Lt(x, hn::Set(d64, 0x80)))) {
+            hn::StoreU(hn::TruncateTo(d8, x), d8, (uint8_t*)out + pos);
+            i += N64;
+            pos += N64;
+            continue;
+        }
+        for (const size_t stop = i + N64; i < stop; ++i) {
+            pos += varint_encode1(out + pos, v[i]);
+        }
+    }
+    for (; i < n; ++i) {
+        pos += varint_encode1(out + pos, v[i]);
+    }
+    return pos;
+}
+
+std::string varint_encode(const uint64_t* v, size_t n) {
+    std::string r(10 * n, '\0');
+    r.resize(varint_encode(v, n, r.data()));
+    return r;
+}
+
+void zigzag_encode(const int64_t* v, size_t n, uint64_t* out) {
+    const hn::ScalableTag<int64_t> di;
+    const hn::RebindToUnsigned<decltype(di)> du;
+    const size_t N = hn::Lanes(di);
+    size_t i       = 0;
+    for (; i + N <= n; i += N) {
+        const auto x = hn::LoadU(di, v + i);
+        hn::StoreU(hn::BitCast(du, hn::Xor(hn::ShiftLeft<1>(x), hn::ShiftRight<63>(x))), du, out + i);
+    }
+    for (; i < n; ++i) {
+        out[i] = zigzag_encode(v[i]);
+    }
+}
+
+void zigzag_decode(const uint64_t* v, size_t n, int64_t* out) {
+    const hn::ScalableTag<int64_t> di;
+    const hn::RebindToUnsigned<decltype(di)> du;
+    const size_t N = hn::Lanes(di);
+    size_t i       = 0;
+    for (; i + N <= n; i += N) {
+        const auto x    = hn::LoadU(du, v + i);
+        const auto sign = hn::Neg(hn::BitCast(di, hn::And(x, hn::Set(du, 1))));
+        hn::StoreU(hn::Xor(hn::BitCast(di, hn::ShiftRight<1>(x)), sign), di, out + i);
+    }
+    for (; i < n; ++i) {
+        out[i] = zigzag_decode(v[i]);
+    }
+}
+
 namespace {
 inline char toupper0(char c) {
     return (c >= 'a' && c <= 'z') ? c - (char)32 : c;
@@ -366,6 +1268,234 @@ std::string str_tolower(std::string_view s) {
     return out;
 }
 
+void str_toupper_inplace(char* s, size_t len) {
+    size_t mod = len % N8;
+    if (len > mod) {
+        detail::UpperUnit upperfn;
+        hn::Unroller(upperfn, (uint8_t*)s, (uint8_t*)s, len - mod);
+    }
+    if (mod > 0) {
+        std::transform(s + len - mod, s + len, s + len - mod, toupper0);
+    }
+}
+
+void str_tolower_inplace(char* s, size_t len) {
+    size_t mod = len % N8;
+    if (len > mod) {
+        detail::LowerUnit lowerfn;
+        hn::Unroller(lowerfn, (uint8_t*)s, (uint8_t*)s, len - mod);
+    }
+    if (mod > 0) {
+        std::transform(s + len - mod, s + len, s + len - mod, tolower0);
+    }
+}
+
+bool str_iequals(std::string_view a, std::string_view b) {
+    return a.size() == b.size()
+           && detail::imcmp((const uint8_t*)a.data(), (const uint8_t*)b.data(), a.size());
+}
+
+bool str_istarts_with(std::string_view s, std::string_view prefix) {
+    const size_t plen = prefix.size();
+    return s.size() >= plen
+           && detail::imcmp((const uint8_t*)s.data(), (const uint8_t*)prefix.data(), plen);
+}
+
+bool str_iends_with(std::string_view s, std::string_view suffix) {
+    const size_t slen = s.size();
+    const size_t plen = suffix.size();
+    const char* ps    = s.data();
+    return slen >= plen
+           && detail::imcmp((const uint8_t*)ps + slen - plen, (const uint8_t*)suffix.data(), plen);
+}
+
+size_t str_ifind(std::string_view s, std::string_view needle, size_t pos) {
+    const size_t slen = s.size();
+    const size_t k    = needle.size();
+    if (pos > slen || k > slen - pos) {
+        return std::string_view::npos;
+    }
+    if (k == 0) {
+        return pos;
+    }
+
+    // refer: http://0x80.pl/articles/simd-strfind.html#generic-sse-avx2
+    // candidates must match the first and the last byte of the needle, the
+    // middle part is verified with `imcmp`.
+    detail::LowerUnit lowerfn;
+    const uint8_t* ps  = (const uint8_t*)s.data();
+    const uint8_t* pn  = (const uint8_t*)needle.data();
+    const auto first   = hn::Set(_du8, (uint8_t)tolower0(needle[0]));
+    const auto last    = hn::Set(_du8, (uint8_t)tolower0(needle[k - 1]));
+    const size_t limit = slen - k + 1;  // candidates: [pos, limit)
+    for (size_t i = pos; i < limit; i += N8) {
+        const size_t n = HWY_MIN(N8, limit - i);
+        const auto x0  = lowerfn.Fold(hn::LoadN(_du8, ps + i, n));
+        const auto x1  = lowerfn.Fold(hn::LoadN(_du8, ps + i + k - 1, n));
+        const auto m   = hn::And(hn::And(hn::Eq(x0, first), hn::Eq(x1, last)), hn::FirstN(_du8, n));
+        for (uint64_t bits = MaskBits(_du8, m); bits != 0; bits &= bits - 1) {
+            const size_t j = hwy::Num0BitsBelowLS1Bit_Nonzero64(bits);
+            if (k <= 2 || detail::imcmp(ps + i + j + 1, pn + 1, k - 2)) {
+                return i + j;
+            }
+        }
+    }
+    return std::string_view::npos;
+}
+
+size_t str_ihash(std::string_view s) {
+    const size_t len  = s.size();
+    const uint8_t* ps = (const uint8_t*)s.data();
+    uint64_t h        = 0x9e3779b97f4a7c15ULL ^ len;
+    HWY_ALIGN uint8_t buf[64];
+    detail::LowerUnit lowerfn;
+    for (size_t i = 0; i < len; i += N8) {
+        const size_t n = HWY_MIN(N8, len - i);
+        hn::Store(lowerfn.Fold(hn::LoadN(_du8, ps + i, n)), _du8, buf);
+        for (size_t j = 0; j < n; j += 8) {
+            uint64_t w;
+            hwy::CopyBytes<8>(buf + j, &w);  // zero padded by LoadN
+            h = detail::hash_mix(h, w);
+        }
+    }
+    return (size_t)detail::hash_final(h);
+}
+
+size_t utf8_validate(std::string_view s) {
+    const uint8_t* p = (const uint8_t*)s.data();
+    const size_t len = s.size();
+    const detail::Utf8Checker checker;
+    const auto _0x80 = hn::Set(_du8, 0x80);
+
+    // on error, rewind to a sequence boundary before `i` and locate it exactly
+    const auto locate = [&](size_t i) {
+        size_t start = i - HWY_MIN(i, 3);
+        while (start < i && (p[start] & 0xc0) == 0x80) {
+            ++start;
+        }
+        return detail::utf8_validate_scalar(p, len, start);
+    };
+
+    // the bytes before the input are treated as ascii
+    HWY_ALIGN uint8_t buf[3 + 64] = {0};
+    size_t i = 0;
+    for (; i + N8 <= len; i += N8) {
+        const uint8_t* q = p + i;
+        if (HWY_UNLIKELY(i < 3)) {
+            hwy::CopyBytes(p, buf + 3, N8);
+            q = buf + 3;
+        }
+        const auto in = hn::LoadU(_du8, q);
+        const auto p3 = hn::LoadU(_du8, q - 3);
+        // ascii fast path: no lead byte in [i - 3, i + N8)
+        if (hn::AllTrue(_du8, hn::Lt(hn::Or(in, p3), _0x80))) {
+            continue;
+        }
+        const auto p2 = hn::LoadU(_du8, q - 2);
+        const auto p1 = hn::LoadU(_du8, q - 1);
+        if (HWY_UNLIKELY(checker.Check(p3, p2, p1, in))) {
+            return locate(i);
+        }
+    }
+    if (i < len) {
+        // tail, zero padded
+        hwy::ZeroBytes(buf, sizeof(buf));
+        const size_t back = HWY_MIN(i, 3);
+        hwy::CopyBytes(p + i - back, buf + 3 - back, len - i + back);
+        const uint8_t* q = buf + 3;
+        const auto in    = hn::LoadU(_du8, q);
+        if (HWY_UNLIKELY(checker.Check(hn::LoadU(_du8, q - 3), hn::LoadU(_du8, q - 2),
+                                       hn::LoadU(_du8, q - 1), in))) {
+            return locate(i);
+        }
+    }
+    // incomplete sequence at the end
+    if ((len >= 1 && p[len - 1] >= 0xc0) || (len >= 2 && p[len - 2] >= 0xe0)
+        || (len >= 3 && p[len - 3] >= 0xf0)) {
+        return locate(len - HWY_MIN(len, 3));
+    }
+    return std::string_view::npos;
+}
+
+std::u16string utf8_to_utf16(std::string_view s) {
+    const uint8_t* p = (const uint8_t*)s.data();
+    const size_t len = s.size();
+    const auto _0x80 = hn::Set(_du8, 0x80);
+    const hn::Half<HWY_FULL(uint8_t)> dh;
+    std::u16string out(len, u'\0');  // utf16 units <= utf8 bytes
+    uint16_t* o = (uint16_t*)out.data();
+    size_t j    = 0;
+
+    for (size_t i = 0; i < len;) {
+        if (i + N8 <= len) {
+            const auto x = hn::LoadU(_du8, p + i);
+            if (hn::AllTrue(_du8, hn::Lt(x, _0x80))) {
+                hn::StoreU(hn::PromoteTo(_du16, hn::LowerHalf(dh, x)), _du16, o + j);
+                hn::StoreU(hn::PromoteTo(_du16, hn::UpperHalf(dh, x)), _du16, o + j + N16);
+                i += N8;
+                j += N8;
+                continue;
+            }
+        }
+        // at least one block of scalar decoding before trying the fast path again
+        const size_t stop = HWY_MIN(len, i + N8);
+        while (i < stop) {
+            uint32_t cp;
+            const int n = detail::utf8_decode(p + i, len - i, cp);
+            if (HWY_UNLIKELY(n == 0)) {
+                throw input_error(i, p[i]);
+            }
+            if (cp < 0x10000) {
+                o[j++] = (uint16_t)cp;
+            } else {
+                cp -= 0x10000;
+                o[j++] = (uint16_t)(0xd800 | (cp >> 10));
+                o[j++] = (uint16_t)(0xdc00 | (cp & 0x3ff));
+            }
+            i += n;
+        }
+    }
+    out.resize(j);
+    return out;
+}
+
+std::string utf16_to_utf8(std::u16string_view s) {
+    const uint16_t* p = (const uint16_t*)s.data();
+    const size_t len  = s.size();
+    const auto _0x80  = hn::Set(_du16, 0x80);
+    const hn::Rebind<uint8_t, HWY_FULL(uint16_t)> d8;
+    std::string out(len * 3, '\0');  // a surrogate pair takes 4 bytes
+    uint8_t* o = (uint8_t*)out.data();
+    size_t j   = 0;
+
+    for (size_t i = 0; i < len;) {
+        if (i + N16 <= len) {
+            const auto x = hn::LoadU(_du16, p + i);
+            if (hn::AllTrue(_du16, hn::Lt(x, _0x80))) {
+                hn::StoreU(hn::DemoteTo(d8, x), d8, o + j);
+                i += N16;
+                j += N16;
+                continue;
+            }
+        }
+        const size_t stop = HWY_MIN(len, i + N16);
+        while (i < stop) {
+            uint32_t cp = p[i];
+            if (cp >= 0xd800 && cp <= 0xdfff) {
+                if (HWY_UNLIKELY(cp >= 0xdc00 || i + 1 >= len || (p[i + 1] & 0xfc00) != 0xdc00)) {
+                    throw input_error(i, (uint8_t)(cp >> 8));
+                }
+                cp = 0x10000 + (((cp & 0x3ff) << 10) | (p[i + 1] & 0x3ff));
+                ++i;
+            }
+            j += detail::utf8_encode(cp, o + j);
+            ++i;
+        }
+    }
+    out.resize(j);
+    return out;
+}
+
 std::vector<std::string_view>  //
 str_split(std::string_view str, std::string_view delimiter, bool trim) {
 #if LC_HAS_MEMMEM
@@ -0,0 +1,105 @@
+#include "lcrypt/token.h"
+#include "detail/base64.h"
+#include "detail/entropy.h"
+#include "detail/hwy.h"
+#include "detail/hex.h"
+#include <stdexcept>
+#include <lcrypt/aes128.h>
+#include <string.h>
+
+namespace {
+
+/// Random bytes per pass, a multiple of 3 that stays in L1 with its encoding
+constexpr size_t kChunk = 3 * 512;
+/// The base64 kernel reads a little before and after its input
+constexpr size_t kSlack = 64;
+
+/// Fills base64 encoded tokens of `n` random bytes, `n % 3 != 0`. Every token is encoded
+/// from whole 3 byte groups with the bits past `n` zeroed, so it decodes to `n` bytes.
+void fill_base64url_groups(char* out, size_t count, size_t n) {
+    HWY_ALIGN char raw[kChunk + 2 * kSlack] = {0};
+    char enc[kChunk / 3 * 4];
+    char* buf          = raw + kSlack;
+    const size_t tlen  = lc::token_base64url_size(n);
+    const size_t group = (n + 2) / 3 * 3;
+    const size_t per   = kChunk / group;
+    for (size_t t = 0; t < count; t += per) {
+        const size_t k = HWY_MIN(per, count - t);
+        lc::secure_random_bytes(buf, k * group);
+        for (size_t i = 0; i < k; ++i) {
+            memset(buf + i * group + n, 0, group - n);
+        }
+        lc::detail::base64_encode_to(buf, k * group, enc, true);
+        for (size_t i = 0; i < k; ++i) {
+            memcpy(out + (t + i) * tlen, enc + i * group / 3 * 4, tlen);
+        }
+    }
+    lc::detail::secure_zero(raw, sizeof(raw));
+    lc::detail::secure_zero(enc, sizeof(enc));
+}
+
+}  // namespace
+
+namespace lc {
+
+std::string random_token_hex(size_t n) {
+    return random_tokens_hex(1, n);
+}
+
+std::string random_token_base64url(size_t n) {
+    return random_tokens_base64url(1, n);
+}
+
+std::string random_tokens_hex(size_t count, size_t n) {
+    if (HWY_UNLIKELY(n != 0 && count > SIZE_MAX / 2 / n)) {
+        throw std::length_error("random_tokens_hex: too large");
+    }
+    std::string arena(count * token_hex_size(n), '\0');
+    // hex tokens are independent of where the bytes are cut
+    HWY_ALIGN char buf[kChunk];
+    const size_t total = count * n;
+    for (size_t i = 0; i < total; i += kChunk) {
+        const size_t k = HWY_MIN(kChunk, total - i);
+        secure_random_bytes(buf, k);
+        detail::hex_encode_to(buf, k, &arena[2 * i]);
+    }
+    detail::secure_zero(buf, sizeof(buf));
+    return arena;
+}
+
+std::string random_tokens_base64url(size_t count, size_t n) {
+    if (HWY_UNLIKELY(n != 0 && count > SIZE_MAX / 2 / n)) {
+        throw std::length_error("random_tokens_base64url: too large");
+    }
+    std::string arena(count * token_base64url_size(n), '\0');
+    if (n % 3 != 0 && n < kChunk) {
+        fill_base64url_groups(arena.data(), count, n);
+        return arena;
+    }
+    // whole groups: token boundaries fall on group boundaries, the tokens are encoded as
+    // one stream. A long token with a partial group only has it at its own end.
+    HWY_ALIGN char raw[kChunk + 2 * kSlack] = {0};
+    char* buf                              = raw + kSlack;
+    char* out                              = arena.data();
+    const size_t whole                     = n / 3 * 3;
+    const size_t step                      = n % 3 == 0 ? count * n : whole;
+    for (size_t t = 0; t < (n % 3 == 0 ? 1 : count); ++t) {
+        for (size_t i = 0; i < step; i += kChunk) {
+            const size_t k = HWY_MIN(kChunk, step - i);
+            secure_random_bytes(buf, k);
+            detail::base64_encode_to(buf, k, out, true);
+            out += k / 3 * 4;
+        }
+        if (n != whole) {
+            const size_t rest = token_base64url_size(n - whole);
+            char enc[4];
+            fill_base64url_groups(enc, 1, n - whole);
+            memcpy(out, enc, rest);
+            out += rest;
+        }
+    }
+    detail::secure_zero(raw, sizeof(raw));
+    return arena;
+}
+
+}  // namespace lc
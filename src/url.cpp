@@ -0,0 +1,284 @@
+#include "lcrypt/url.h"
+#include "detail/hex.h"
+#include "detail/hwy.h"
+#include <string>
+#include <string.h>
+
+namespace {
+
+using mask8_t = hn::Mask<HWY_FULL(u8)>;
+
+struct UrlClassifier {
+    const vu8 _0x20    = hn::Set(_du8, 0x20);
+    const vu8 _a       = hn::Set(_du8, 'a');
+    const vu8 _0       = hn::Set(_du8, '0');
+    const vu8 _26      = hn::Set(_du8, 26);
+    const vu8 _10      = hn::Set(_du8, 10);
+    const vu8 _minus   = hn::Set(_du8, '-');
+    const vu8 _dot     = hn::Set(_du8, '.');
+    const vu8 _under   = hn::Set(_du8, '_');
+    const vu8 _tilde   = hn::Set(_du8, '~');
+    const vu8 _percent = hn::Set(_du8, '%');
+    const vu8 _plus    = hn::Set(_du8, '+');
+
+    /// lanes kept as is by url_encode
+    mask8_t Unreserved(const vu8 x) const {
+        const auto alpha = hn::Lt(hn::Sub(hn::Or(x, _0x20), _a), _26);
+        const auto digit = hn::Lt(hn::Sub(x, _0), _10);
+        const auto mark0 = hn::Or(hn::Eq(x, _minus), hn::Eq(x, _dot));
+        const auto mark1 = hn::Or(hn::Eq(x, _under), hn::Eq(x, _tilde));
+        return hn::Or(hn::Or(alpha, digit), hn::Or(mark0, mark1));
+    }
+
+    /// lanes url_decode has to rewrite
+    mask8_t Escape(const vu8 x, bool form) const {
+        const auto m = hn::Eq(x, _percent);
+        return form ? hn::Or(m, hn::Eq(x, _plus)) : m;
+    }
+};
+
+/// Encodes p[i, len) into `out`, returns the bytes written.
+size_t encode(const u8* p, size_t i, size_t len, u8* out, bool form) {
+    static constexpr char _hex[] = "0123456789ABCDEF";
+    const UrlClassifier cls;
+    size_t j = 0;
+    for (; i < len; i += N8) {
+        const size_t n = HWY_MIN(N8, len - i);
+        const auto x   = hn::LoadN(_du8, p + i, n);
+        const auto m   = hn::AndNot(cls.Unreserved(x), hn::FirstN(_du8, n));
+        if (hn::AllFalse(_du8, m)) {
+            hn::StoreN(x, _du8, out + j, n);
+            j += n;
+            continue;
+        }
+        size_t k = 0;
+        for (uint64_t bits = MaskBits(_du8, m); bits != 0; bits &= bits - 1) {
+            const size_t b = hwy::Num0BitsBelowLS1Bit_Nonzero64(bits);
+            const u8 c     = p[i + b];
+            hwy::CopyBytes(p + i + k, out + j, b - k);
+            j += b - k;
+            if (form && c == ' ') {
+                out[j++] = '+';
+            } else {
+                out[j]     = '%';
+                out[j + 1] = _hex[c >> 4];
+                out[j + 2] = _hex[c & 0xf];
+                j += 3;
+            }
+            k = b + 1;
+        }
+        hwy::CopyBytes(p + i + k, out + j, n - k);
+        j += n - k;
+    }
+    return j;
+}
+
+/// Decodes p[i, len) into `out`, returns the bytes written. Error offsets are relative to `p`.
+size_t decode(const u8* p, size_t i, size_t len, u8* out, bool form) {
+    const UrlClassifier cls;
+    const lc::detail::HexNibbleLut lut;
+    HWY_ALIGN u8 nibbles[N8];
+    size_t j = 0;
+    while (i < len) {
+        const size_t n    = HWY_MIN(N8, len - i);
+        const auto valid  = hn::FirstN(_du8, n);
+        const auto x      = hn::LoadN(_du8, p + i, n);
+        const auto m      = hn::And(cls.Escape(x, form), valid);
+        if (hn::AllFalse(_du8, m)) {
+            hn::StoreN(x, _du8, out + j, n);
+            i += n;
+            j += n;
+            continue;
+        }
+        // hex pairs inside the block come from the nibble LUT, those straddling its end
+        // are decoded one byte at a time
+        hn::Store(lut.Decode(x), _du8, nibbles);
+        const uint64_t hex = MaskBits(_du8, hn::And(lut.Valid(x), valid));
+        size_t k           = 0;
+        for (uint64_t bits = MaskBits(_du8, m); bits != 0; bits &= bits - 1) {
+            const size_t b = hwy::Num0BitsBelowLS1Bit_Nonzero64(bits);
+            hwy::CopyBytes(p + i + k, out + j, b - k);
+            j += b - k;
+            if (p[i + b] == '+') {
+                out[j++] = ' ';
+                k        = b + 1;
+                continue;
+            }
+            u8 hi, lo;
+            if (HWY_LIKELY(b + 2 < n)) {
+                if (HWY_UNLIKELY(((hex >> (b + 1)) & 3) != 3)) {
+                    const size_t bad = (hex >> (b + 1)) & 1 ? b + 2 : b + 1;
+                    throw lc::input_error(i + bad, p[i + bad]);
+                }
+                hi = nibbles[b + 1];
+                lo = nibbles[b + 2];
+            } else {
+                if (HWY_UNLIKELY(i + b + 2 >= len)) {
+                    throw lc::input_error(i + b, p[i + b]);
+                }
+                hi = lc::detail::hex_nibble(p[i + b + 1]);
+                lo = lc::detail::hex_nibble(p[i + b + 2]);
+                if (HWY_UNLIKELY(hi > 15 || lo > 15)) {
+                    const size_t bad = hi > 15 ? b + 1 : b + 2;
+                    throw lc::input_error(i + bad, p[i + bad]);
+                }
+            }
+            out[j++] = (hi << 4) | lo;
+            // an escape inside the consumed pair is not a hex digit and has thrown above
+            k = b + 3;
+        }
+        if (k < n) {
+            hwy::CopyBytes(p + i + k, out + j, n - k);
+            j += n - k;
+        }
+        i += HWY_MAX(k, n);
+    }
+    return j;
+}
+
+/// Offset of the first byte url_decode has to rewrite, or `len`.
+size_t find_escape(const u8* p, size_t len, bool form) {
+    const UrlClassifier cls;
+    for (size_t i = 0; i < len; i += N8) {
+        const size_t n = HWY_MIN(N8, len - i);
+        const auto x   = hn::LoadN(_du8, p + i, n);
+        const auto b   = hn::FindFirstTrue(_du8, hn::And(cls.Escape(x, form), hn::FirstN(_du8, n)));
+        if (b >= 0) {
+            return i + b;
+        }
+    }
+    return len;
+}
+
+}  // namespace
+
+namespace lc {
+
+size_t url_encode_size(const char* in, size_t len, bool form) {
+    const UrlClassifier cls;
+    const vu8 _space = hn::Set(_du8, ' ');
+    const u8* p      = (const u8*)in;
+    size_t extra     = 0;
+    for (size_t i = 0; i < len; i += N8) {
+        const size_t n   = HWY_MIN(N8, len - i);
+        const auto valid = hn::FirstN(_du8, n);
+        const auto x     = hn::LoadN(_du8, p + i, n);
+        const auto m     = hn::AndNot(cls.Unreserved(x), valid);
+        if (hn::AllFalse(_du8, m)) {
+            continue;
+        }
+        size_t nesc = hn::CountTrue(_du8, m);
+        if (form) {
+            nesc -= hn::CountTrue(_du8, hn::And(hn::Eq(x, _space), valid));
+        }
+        extra += 2 * nesc;
+    }
+    return len + extra;
+}
+
+std::string url_encode(const char* in, size_t len, bool form) {
+    std::string result(url_encode_size(in, len, form), '\0');
+    encode((const u8*)in, 0, len, (u8*)result.data(), form);
+    return result;
+}
+
+std::string url_decode(const char* in, size_t len, bool form) {
+    std::string result(len, '\0');
+    result.resize(decode((const u8*)in, 0, len, (u8*)result.data(), form));
+    return result;
+}
+
+std::string_view url_encode(std::string_view s, std::string& buf, bool form) {
+    const size_t size = url_encode_size(s.data(), s.size(), form);
+    if (size == s.size() && !(form && memchr(s.data(), ' ', s.size()))) {
+        return s;
+    }
+    buf.resize(size);
+    encode((const u8*)s.data(), 0, s.size(), (u8*)buf.data(), form);
+    return buf;
+}
+
+std::string_view url_decode(std::string_view s, std::string& buf, bool form) {
+    const u8* p      = (const u8*)s.data();
+    const size_t pos = find_escape(p, s.size(), form);
+    if (pos == s.size()) {
+        return s;
+    }
+    buf.resize(s.size());
+    hwy::CopyBytes(p, buf.data(), pos);
+    buf.resize(pos + decode(p, pos, s.size(), (u8*)buf.data() + pos, form));
+    return buf;
+}
+
+url_params url_parse_query(std::string_view query, std::string& buf) {
+    const vu8 _amp    = hn::Set(_du8, '&');
+    const vu8 _eq     = hn::Set(_du8, '=');
+    const UrlClassifier cls;
+    const u8* p       = (const u8*)query.data();
+    const size_t len  = query.size();
+    url_params result;
+
+    // decoded output never outgrows the input, so views into `buf` stay valid
+    buf.clear();
+    buf.reserve(len);
+
+    size_t start  = 0;      // first byte of the current key or value
+    bool dirty    = false;  // the current key or value has '%' or '+'
+    bool in_value = false;
+    std::string_view key;
+
+    auto field = [&](size_t end) -> std::string_view {
+        const size_t from = start;
+        const bool esc    = dirty;
+        dirty             = false;
+        if (!esc) {
+            return query.substr(from, end - from);
+        }
+        const size_t old = buf.size();
+        buf.resize(old + (end - from));
+        const size_t n = decode(p, from, end, (u8*)buf.data() + old, true);
+        buf.resize(old + n);
+        return std::string_view(buf.data() + old, n);
+    };
+
+    auto finish = [&](size_t end) {
+        if (in_value) {
+            result.emplace_back(key, field(end));
+        } else if (end != start) {
+            result.emplace_back(field(end), std::string_view());
+        }
+        in_value = false;
+        dirty    = false;
+        start    = end + 1;
+    };
+
+    for (size_t i = 0; i < len; i += N8) {
+        const size_t n   = HWY_MIN(N8, len - i);
+        const auto valid = hn::FirstN(_du8, n);
+        const auto x     = hn::LoadN(_du8, p + i, n);
+        const auto amp   = hn::And(hn::Eq(x, _amp), valid);
+        const auto eq    = hn::Eq(x, _eq);
+        uint64_t esc     = MaskBits(_du8, hn::And(cls.Escape(x, true), valid));
+        uint64_t sep     = MaskBits(_du8, hn::And(hn::Or(amp, eq), valid));
+        const uint64_t a = MaskBits(_du8, amp);
+        for (; sep != 0; sep &= sep - 1) {
+            const size_t b       = hwy::Num0BitsBelowLS1Bit_Nonzero64(sep);
+            const uint64_t below = (uint64_t(1) << b) - 1;
+            dirty |= (esc & below) != 0;
+            esc &= ~below;
+            if ((a >> b) & 1) {
+                finish(i + b);
+            } else if (!in_value) {
+                key      = field(i + b);
+                in_value = true;
+                start    = i + b + 1;
+            }
+            // a later '=' belongs to the value
+        }
+        dirty |= esc != 0;
+    }
+    finish(len);
+    return result;
+}
+
+}  // namespace lc
@@ -1,5 +1,8 @@
+#include <set>
+#include <thread>
 #include <gtest/gtest.h>
 #include <lcrypt/aes128.h>
+#include <lcrypt/hex.h>
 
 using namespace lc;
 
@@ -19,3 +22,74 @@ TEST(crypto, aes128) {
     EXPECT_EQ(to_span(aes128_dec(cipher1, "123")), plain1);
     EXPECT_EQ(to_span(aes128_dec(cipher2, "123")), plain2);
 }
+
+TEST(crypto, ctr_drbg) {
+    uint8_t entropy[64];
+    for (int i = 0; i < 64; i++) {
+        entropy[i] = (uint8_t)i;
+    }
+    // checked against the SP 800-90A steps on top of openssl aes-128-ecb
+    ctr_drbg drbg(entropy, "lcrypt");
+    std::vector<uint8_t> out(64);
+    drbg.generate(out.data(), 64);
+    EXPECT_EQ(hex_encode(out),
+              "5b34d31f8ab36f43948f1932e77e5fc37cfa2cb090386cc73c0c4f93eaadc4a0"
+              "68b542ac7623fce7d242eefda12599876d84875742fda68930a2b2af39ff3f72");
+    out.resize(37);
+    drbg.generate(out.data(), 37);
+    EXPECT_EQ(hex_encode(out),
+              "e11d6c4ab2a83e3ddc93669a319c1096a7692214db3ba7751651fb88dd41f7b345edfbcc92");
+    EXPECT_EQ(drbg.reseed_counter(), 3);
+    drbg.reseed(entropy + 32, "again");
+    EXPECT_EQ(drbg.reseed_counter(), 1);
+    out.resize(64);
+    drbg.generate(out.data(), 64);
+    EXPECT_EQ(hex_encode(out),
+              "dee252e65b007b0e5dc8c84fdffd1e61807f94b39e2aa20286e6b5a70c471f53"
+              "ae803cd37383bee53a52952171bca70a0e1b02912d65564951cd983d48e82450");
+
+    // the first request of any size is a prefix of the counter stream
+    std::vector<uint8_t> whole(1000), part(1000);
+    ctr_drbg(entropy).generate(whole.data(), whole.size());
+    for (size_t n = 0; n < whole.size(); n += 7) {
+        ctr_drbg(entropy).generate(part.data(), n);
+        ASSERT_TRUE(std::equal(part.begin(), part.begin() + n, whole.begin())) << n;
+    }
+
+    EXPECT_THROW(ctr_drbg(entropy, std::string(33, 'x')), std::invalid_argument);
+    EXPECT_THROW(drbg.generate(whole.data(), ctr_drbg::kMaxRequest + 1), std::invalid_argument);
+}
+
+TEST(crypto, secure_random_bytes) {
+    std::set<std::string> seen;
+    char token[16];
+    for (int i = 0; i < 10000; i++) {
+        secure_random_bytes(token, sizeof(token));
+        seen.emplace(token, sizeof(token));
+    }
+    EXPECT_EQ(seen.size(), 10000);
+
+    // small sizes from the buffer, large ones straight from the generator
+    for (size_t n : {0, 1, 15, 17, 255, 256, 257, 5000, 200000}) {
+        std::vector<uint8_t> a(n + 1, 0), b(n + 1, 0);
+        secure_random_bytes(a.data(), n);
+        secure_random_bytes(b.data(), n);
+        EXPECT_EQ(a[n], 0);
+        if (n >= 8) {
+            EXPECT_NE(a, b);
+        }
+    }
+
+    std::vector<std::string> per_thread(4);
+    std::vector<std::thread> threads;
+    for (auto& s : per_thread) {
+        threads.emplace_back([&s] {
+            s.resize(32);
+            secure_random_bytes(s.data(), s.size());
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(std::set<std::string>(per_thread.begin(), per_thread.end()).size(), 4);
+}
@@ -1,4 +1,11 @@
 
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
 #include <gtest/gtest.h>
 #include <lcrypt/base.h>
 
@@ -20,3 +27,278 @@ TEST(crypto, random) {
         EXPECT_TRUE(r >= 0 && r < 1.0);
     }
 }
+
+TEST(crypto, random_threads) {
+    static constexpr int nthreads = 4;
+    static constexpr int times    = 1e5;
+    std::vector<std::vector<double>> draws(nthreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nthreads; t++) {
+        threads.emplace_back([&draws, t] {
+            auto& d = draws[t];
+            for (int i = 0; i < times; i++) {
+                d.push_back(lc::random());
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+
+    // every thread has its own stream
+    for (int t = 0; t < nthreads; t++) {
+        for (double r : draws[t]) {
+            ASSERT_TRUE(r >= 0 && r < 1.0);
+        }
+        for (int u = t + 1; u < nthreads; u++) {
+            EXPECT_NE(draws[t], draws[u]);
+        }
+    }
+}
+
+TEST(crypto, random_thread_streams) {
+    // threads that come and go reuse the stream ids, without replaying the draws
+    static constexpr int nthreads = 4;
+    static constexpr int rounds   = 200;
+    lc::random(); /* this thread holds an id too */
+    const uint64_t self = lc::detail::thread_stream_id();
+    std::set<uint64_t> ids;
+    std::set<double> firsts;
+    for (int r = 0; r < rounds; r++) {
+        std::vector<uint64_t> id(nthreads);
+        std::vector<double> first(nthreads);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < nthreads; t++) {
+            threads.emplace_back([&id, &first, t] {
+                first[t] = lc::random();
+                id[t]    = lc::detail::thread_stream_id();
+            });
+        }
+        for (auto& th : threads) {
+            th.join();
+        }
+        ids.insert(id.begin(), id.end());
+        firsts.insert(first.begin(), first.end());
+    }
+    EXPECT_EQ(ids.count(self), 0u);
+    EXPECT_LE(ids.size(), (size_t)nthreads);
+    EXPECT_LE(*ids.rbegin(), (uint64_t)nthreads);
+    EXPECT_EQ(firsts.size(), (size_t)nthreads * rounds);
+}
+
+TEST(crypto, random_bulk) {
+    // exact length, the guard bytes stay
+    for (size_t n = 0; n < 200; n++) {
+        std::vector<uint8_t> b(n + 8, 0xa5);
+        lc::random_bytes(b.data(), n);
+        for (size_t i = n; i < n + 8; i++) {
+            ASSERT_EQ(b[i], 0xa5);
+        }
+    }
+    std::vector<uint8_t> bytes(1 << 16);
+    lc::random_bytes(bytes.data(), bytes.size());
+    std::vector<int> seen(256);
+    for (auto c : bytes) {
+        seen[c]++;
+    }
+    for (int c : seen) {
+        EXPECT_GT(c, 128);
+    }
+
+    std::vector<double> ds(100003);
+    lc::random_fill(ds.data(), ds.size());
+    double sum = 0;
+    for (double d : ds) {
+        ASSERT_TRUE(d >= 0 && d < 1.0);
+        sum += d;
+    }
+    EXPECT_NEAR(sum / ds.size(), 0.5, 0.01);
+
+    std::vector<int64_t> is(100003);
+    const std::pair<int64_t, int64_t> ranges[] = {
+        {-3, 3}, {5, 5}, {0, 1}, {-1, (int64_t)UINT32_MAX - 1}, {0, (int64_t)1 << 40}, {INT64_MIN, -1}};
+    for (auto [lo, hi] : ranges) {
+        lc::random_uniform_ints(is.data(), is.size(), lo, hi);
+        for (auto x : is) {
+            ASSERT_TRUE(x >= lo && x <= hi) << x;
+        }
+    }
+    lc::random_uniform_ints(is.data(), is.size(), -3, 3);
+    std::vector<int> hist(7);
+    for (auto x : is) {
+        hist[x + 3]++;
+    }
+    for (int h : hist) {
+        EXPECT_NEAR(h, is.size() / 7.0, is.size() / 70.0);
+    }
+    lc::random_uniform_ints(is.data(), is.size(), INT64_MIN, INT64_MAX);
+    EXPECT_NE(is[0], is[1]);
+    EXPECT_THROW(lc::random_uniform_ints(is.data(), 1, 1, 0), std::invalid_argument);
+
+    EXPECT_NE(lc::random(0, SIZE_MAX), lc::random(0, SIZE_MAX));
+}
+
+TEST(crypto, rng) {
+    lc::rng a(42), b(42), c(42, 1);
+    std::vector<uint64_t> va, vc;
+    for (int i = 0; i < 100; i++) {
+        va.push_back(a());
+        vc.push_back(c());
+        ASSERT_EQ(va.back(), b());
+    }
+    EXPECT_NE(va, vc);
+
+    // the same values whatever the vector width
+    lc::rng g(1);
+    EXPECT_EQ(g(), 14971601782005023387ull); /* xoshiro256++ from splitmix64(1) */
+    int64_t is[40];
+    g.uniform_ints(is, 40, -100, 100);
+    EXPECT_EQ(is[0], 17);
+    EXPECT_EQ(is[39], 49);
+    uint8_t bytes[13];
+    g.bytes(bytes, 13);
+    EXPECT_EQ(bytes[12], 0xe1);
+    EXPECT_EQ(g(), 16423951231182284614ull);
+
+    // bulk draws continue the same streams
+    lc::rng x(9), y(9);
+    double d[33];
+    x.fill(d, 33);
+    for (double v : d) {
+        ASSERT_TRUE(v >= 0 && v < 1.0);
+    }
+    y.fill(d, 33);
+    EXPECT_EQ(x(), y());
+    EXPECT_EQ(x.uniform(5, 9), y.uniform(5, 9));
+    EXPECT_THROW(x.uniform(9, 5), std::invalid_argument);
+
+    // long_jump() is the next stream, jump() leaves all the lanes behind
+    lc::rng j(42);
+    j.long_jump();
+    for (int i = 0; i < 100; i++) {
+        ASSERT_EQ(j(), vc[i]);
+    }
+    lc::rng k(42);
+    k.jump();
+    std::vector<uint64_t> vk;
+    for (int i = 0; i < 100; i++) {
+        vk.push_back(k());
+    }
+    EXPECT_NE(vk, va);
+
+    std::uniform_int_distribution<int> dist(1, 6);
+    const int r = dist(a);
+    EXPECT_TRUE(r >= 1 && r <= 6);
+    EXPECT_NE(lc::random_seed(), lc::random_seed());
+}
+
+TEST(crypto, random_sampling) {
+    // a permutation, every order of 3 about as likely
+    std::vector<int> v(1000);
+    std::iota(v.begin(), v.end(), 0);
+    lc::shuffle(v);
+    EXPECT_FALSE(std::is_sorted(v.begin(), v.end()));
+    std::sort(v.begin(), v.end());
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_EQ(v[i], i);
+    }
+    std::map<std::string, int> orders;
+    for (int i = 0; i < 60000; i++) {
+        std::string s = "abc";
+        lc::shuffle(s);
+        orders[s]++;
+    }
+    EXPECT_EQ(orders.size(), 6u);
+    for (auto& [s, c] : orders) {
+        EXPECT_NEAR(c, 10000, 500) << s;
+    }
+    int one = 1;
+    lc::shuffle(&one, 1);
+    lc::shuffle(&one, 0);
+    EXPECT_EQ(one, 1);
+
+    // ranges past 2^32, and just under it where most lanes check the threshold
+    uint64_t big[40];
+    for (uint64_t top : {(uint64_t)1 << 33, (uint64_t)UINT32_MAX + 20, (uint64_t)UINT32_MAX - 1}) {
+        lc::detail::shuffle_draws(big, 40, top);
+        for (int i = 0; i < 40; i++) {
+            ASSERT_LE(big[i], top - i);
+        }
+        EXPECT_NE(big[20], big[21]);
+    }
+
+    // distinct, both the dense and the sparse way
+    for (auto [n, k] : {std::pair<size_t, size_t>{0, 0}, {10, 10}, {1000, 900}, {100000, 50}}) {
+        auto s = lc::sample_indices(n, k);
+        ASSERT_EQ(s.size(), k);
+        std::set<size_t> u(s.begin(), s.end());
+        EXPECT_EQ(u.size(), k);
+        EXPECT_TRUE(k == 0 || *u.rbegin() < n);
+    }
+    std::vector<int> first(20), any(20);
+    for (int i = 0; i < 20000; i++) {
+        auto s = lc::sample_indices(20, 2);
+        first[s[0]]++;
+        any[s[0]]++;
+        any[s[1]]++;
+    }
+    for (int i = 0; i < 20; i++) {
+        EXPECT_NEAR(first[i], 1000, 150);
+        EXPECT_NEAR(any[i], 2000, 250);
+    }
+    EXPECT_THROW(lc::sample_indices(3, 4), std::invalid_argument);
+
+    // weighted
+    const std::vector<double> w = {1, 2, 3, 0, 4};
+    lc::weighted_choice pick(w);
+    lc::rng wg(7);
+    std::vector<size_t> out(100000);
+    pick(wg, out.data(), out.size());
+    std::vector<int> hist(5);
+    for (auto i : out) {
+        hist[i]++;
+    }
+    hist[pick(wg)]++;
+    hist[pick()]++;
+    EXPECT_EQ(hist[3], 0);
+    // sd of the 0.4 bucket is 155, 900 is near 6 sd
+    for (int i = 0; i < 5; i++) {
+        EXPECT_NEAR(hist[i], 10000 * w[i], 900) << i;
+    }
+    EXPECT_EQ(lc::weighted_choice(std::vector<double>{0, 5})(), 1u);
+    EXPECT_THROW(lc::weighted_choice(std::vector<double>{}), std::invalid_argument);
+    EXPECT_THROW(lc::weighted_choice(std::vector<double>{1, -1}), std::invalid_argument);
+    EXPECT_THROW(lc::weighted_choice(std::vector<double>{0, 0}), std::invalid_argument);
+
+    // with an rng, the same values whatever the vector width
+    lc::rng a(3), b(3);
+    std::vector<int> x(50), y(50);
+    std::iota(x.begin(), x.end(), 0);
+    std::iota(y.begin(), y.end(), 0);
+    lc::shuffle(a, x);
+    lc::shuffle(b, y);
+    EXPECT_EQ(x, y);
+    auto sa = lc::sample_indices(a, 1000, 10);
+    EXPECT_EQ(sa, lc::sample_indices(b, 1000, 10));
+    size_t pa[30], pb[30];
+    pick(a, pa, 30);
+    pick(b, pb, 30);
+    EXPECT_TRUE(std::equal(pa, pa + 30, pb));
+    EXPECT_EQ(pick(a), pick(b));
+    EXPECT_EQ(x[0], 30);
+    EXPECT_EQ(x[49], 36);
+    EXPECT_EQ(sa[0], 561u);
+    EXPECT_EQ(pa[29], 4u);
+}
+
+TEST(crypto, constant_time_equal) {
+    std::string a(100, 'x'), b = a;
+    for (size_t n = 0; n <= a.size(); n++) {
+        ASSERT_TRUE(lc::constant_time_equal(a.data(), b.data(), n));
+        if (n > 0) {
+            b[n - 1] = 'y';
+            ASSERT_FALSE(lc::constant_time_equal(a.data(), b.data(), n));
+            b[n - 1] = 'x';
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <lcrypt/hex.h>
+#include <stdint.h>
+
+namespace test {
+
+/// Lowercase hex of a digest or MAC
+template <size_t N>
+std::string hex(const std::array<uint8_t, N>& d) {
+    return lc::hex_encode((const char*)d.data(), d.size());
+}
+
+/// `n` bytes that do not repeat over short ranges
+inline std::string pattern(size_t n) {
+    std::string data(n, '\0');
+    for (size_t i = 0; i < n; ++i) {
+        data[i] = (char)(i * 131 + (i >> 7) * 7 + 3);
+    }
+    return data;
+}
+
+/// Messages for the batch hashes: lengths around the padding edges of 64 byte blocks at
+/// offsets 0, 1 and 2, mixed so the lanes finish at different steps, more of them than lanes
+inline const std::vector<std::string_view>& boundary_messages() {
+    static const std::string data = [] {
+        std::string s;
+        for (int i = 0; i < 1000; ++i) {
+            s.push_back((char)(i * 7 + 1));
+        }
+        return s;
+    }();
+    static const std::vector<std::string_view> msgs = [] {
+        std::vector<std::string_view> m;
+        for (size_t len : {0, 1, 55, 56, 63, 64, 65, 119, 120, 128, 300, 1000, 3, 0, 17, 24, 999}) {
+            for (size_t k = 0; k < 3; ++k) {
+                m.emplace_back(data.data() + k, std::min(len, data.size() - k));
+            }
+        }
+        return m;
+    }();
+    return msgs;
+}
+
+}  // namespace test
@@ -0,0 +1,48 @@
+#include <string>
+#include <gtest/gtest.h>
+#include <lcrypt/crc32.h>
+#include "common.h"
+
+using namespace lc;
+
+static uint32_t crc_bitwise(const std::string& s, uint32_t poly, uint32_t crc = 0) {
+    crc = ~crc;
+    for (unsigned char c : s) {
+        crc ^= c;
+        for (int k = 0; k < 8; ++k) {
+            crc = crc & 1 ? (crc >> 1) ^ poly : crc >> 1;
+        }
+    }
+    return ~crc;
+}
+
+TEST(crypto, crc32) {
+    EXPECT_EQ(crc32c(std::string("123456789")), 0xe3069283u);
+    EXPECT_EQ(crc32(std::string("123456789")), 0xcbf43926u);
+    EXPECT_EQ(crc32c(std::string()), 0u);
+    EXPECT_EQ(crc32(std::string()), 0u);
+    // iSCSI (RFC 3720 B.4)
+    EXPECT_EQ(crc32c(std::string(32, '\0')), 0x8a9136aau);
+    EXPECT_EQ(crc32c(std::string(32, '\xff')), 0x62a8ab43u);
+
+    // every length across the vector paths and their tails
+    const std::string data = test::pattern(5000);
+    for (size_t len = 0; len <= 1100; len += len < 300 ? 1 : 37) {
+        for (size_t off : {0, 1, 13}) {
+            const std::string s = data.substr(off, len);
+            EXPECT_EQ(crc32c(s), crc_bitwise(s, 0x82f63b78)) << len << ' ' << off;
+            EXPECT_EQ(crc32(s), crc_bitwise(s, 0xedb88320)) << len << ' ' << off;
+        }
+    }
+    EXPECT_EQ(crc32c(data), crc_bitwise(data, 0x82f63b78));
+    EXPECT_EQ(crc32(data), crc_bitwise(data, 0xedb88320));
+
+    // incremental and combine
+    for (size_t cut : {0, 1, 7, 64, 255, 1000, 4999, 5000}) {
+        const std::string a = data.substr(0, cut), b = data.substr(cut);
+        EXPECT_EQ(crc32c(b, crc32c(a)), crc32c(data)) << cut;
+        EXPECT_EQ(crc32(b, crc32(a)), crc32(data)) << cut;
+        EXPECT_EQ(crc32c_combine(crc32c(a), crc32c(b), b.size()), crc32c(data)) << cut;
+        EXPECT_EQ(crc32_combine(crc32(a), crc32(b), b.size()), crc32(data)) << cut;
+    }
+}
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include <lcrypt/csv.h>
+
+using namespace lc;
+using row_t  = std::vector<std::string_view>;
+using rows_t = std::vector<std::vector<std::string>>;
+
+static rows_t read_all(std::string_view data, char delimiter = ',') {
+    rows_t rows;
+    csv_reader reader(data, delimiter);
+    row_t fields;
+    while (reader.next(fields)) {
+        rows.emplace_back(fields.begin(), fields.end());
+    }
+    return rows;
+}
+
+TEST(crypto, csv) {
+    std::string a = "abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    std::string data = "id,name,comment\r\n"
+                       "1,\"" + a + ",\nx\",plain\n"
+                       "\n"
+                       "2,\"say \"\"hi\"\"\",\"\"\r\n"
+                       ",,\n"
+                       "3," + a + a + ",last";
+
+    csv_reader reader(data);
+    row_t fields;
+    ASSERT_TRUE(reader.next(fields));
+    EXPECT_EQ(fields, (row_t{"id", "name", "comment"}));
+    ASSERT_TRUE(reader.next(fields));
+    EXPECT_EQ(fields, (row_t{"1", a + ",\nx", "plain"}));
+    EXPECT_EQ(fields[1].data(), data.data() + data.find(a));  // zero-copy
+    ASSERT_TRUE(reader.next(fields));
+    EXPECT_EQ(fields, (row_t{"2", "say \"hi\"", ""}));
+    ASSERT_TRUE(reader.next(fields));
+    EXPECT_EQ(fields, (row_t{"", "", ""}));
+    ASSERT_TRUE(reader.next(fields));
+    EXPECT_EQ(fields, (row_t{"3", a + a, "last"}));
+    EXPECT_FALSE(reader.next(fields));
+    EXPECT_FALSE(reader.next(fields));
+    EXPECT_EQ(reader.offset(), data.size());
+
+    // every split of quoted content across 64-byte blocks
+    for (size_t i = 0; i < 70; ++i) {
+        std::string pad(i, 'p');
+        auto rows = read_all(pad + ",\"a,\"\"b\"\"\nc\"," + a + "\n" + pad);
+        ASSERT_EQ(rows.size(), i ? 2u : 1u);
+        EXPECT_EQ(rows[0], (std::vector<std::string>{pad, "a,\"b\"\nc", a}));
+    }
+
+    EXPECT_EQ(read_all("a\tb\t\"c\td\"\n", '\t'), (rows_t{{"a", "b", "c\td"}}));
+    EXPECT_EQ(read_all("x\"y\",z\n"), (rows_t{{"x\"y\"", "z"}}));
+    EXPECT_TRUE(read_all("").empty());
+    EXPECT_TRUE(read_all("\n\r\n").empty());
+    EXPECT_THROW(read_all("a,\"bc\nd"), input_error);
+}
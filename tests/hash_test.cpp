@@ -0,0 +1,76 @@
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <lcrypt/hash.h>
+#include "common.h"
+
+using namespace lc;
+
+TEST(crypto, hash64) {
+    // xxhash 0.8 XXH3_64bits_withSeed, every length class and block boundaries
+    const size_t lens[] = {0,   1,   3,   4,   8,   9,   16,  17,   32,   33,   64,  65,
+                           96,  97,  128, 129, 200, 240, 241, 1024, 1025, 2048, 5000};
+    const uint64_t unseeded[] = {
+        0x2d06800538d394c2, 0x13e608bc156defed, 0x974a8c6fa70c32a8, 0xd53c28cdece5352d,
+        0xd4d9e4c499ebd3fc, 0xd6fde0887a1893ca, 0xca4738193200d5bf, 0x02ec68113d62488b,
+        0xd5cb55f2bd3ab281, 0x177fc93b526aa0a0, 0x37d7807c33e74a3c, 0xff48cb982e5fcb12,
+        0xef2dac2823b8855c, 0x2fcb41d8c85c1417, 0xa67ae43aec758836, 0x5e45a7aab17f409c,
+        0x84b462000df28583, 0xfcd6ac75c4925fc2, 0xe7b344ff3a8cf901, 0xdd1542b6df71e11d,
+        0x770e407a1e52af48, 0x4cf708e70f9f2336, 0x1e129b00c7aa3e87};
+    const uint64_t seeded[] = {
+        0x602b0e2cd6662c8b, 0x1b4c466098160569, 0xe64773622da99804, 0x2776c97b94757838,
+        0x78af5875a0fa46dc, 0xef751e153671c05e, 0x4e077131807a77b9, 0x8b13f9caef59e73e,
+        0x0e5cc05de67a87e3, 0x2a77ee8d304c5be9, 0x6a43f2b4fe26c6d9, 0x2dc08d1f83cb2a81,
+        0xe3bcddb8ac943528, 0x89a1a0bf96d15375, 0x96650bb827c71283, 0x29e6a00244594981,
+        0x0252979643ffd648, 0x2ed8c71cfb5bb513, 0xe82282e3f49fef9a, 0xbe8f14949c4096e8,
+        0xc01bc877978aeff1, 0x7f29b5bd505ece4a, 0xc7083731822131a6};
+    const uint64_t seed = 0x9e3779b97f4a7c15;
+    const std::string data = test::pattern(5000);
+
+    std::vector<std::string_view> keys;
+    for (size_t i = 0; i < std::size(lens); ++i) {
+        const std::string s = data.substr(0, lens[i]);
+        EXPECT_EQ(hash64(s), unseeded[i]) << lens[i];
+        EXPECT_EQ(hash64(s, seed), seeded[i]) << lens[i];
+        keys.emplace_back(data.data(), lens[i]);
+    }
+    std::vector<uint64_t> out(keys.size());
+    hash64_batch(keys.data(), keys.size(), out.data());
+    EXPECT_EQ(out, std::vector<uint64_t>(std::begin(unseeded), std::end(unseeded)));
+    hash64_batch(keys.data(), keys.size(), out.data(), seed);
+    EXPECT_EQ(out, std::vector<uint64_t>(std::begin(seeded), std::end(seeded)));
+}
+
+TEST(crypto, siphash) {
+    siphash_key key;
+    for (int i = 0; i < 16; ++i) {
+        key[i] = (uint8_t)i;
+    }
+    std::string msg(63, '\0');
+    for (int i = 0; i < 63; ++i) {
+        msg[i] = (char)i;
+    }
+    // the reference vectors of the SipHash paper, key 00..0f and message 00..(len - 1)
+    EXPECT_EQ(siphash24(key, std::string()), 0x726fdb47dd0e0e31u);
+    EXPECT_EQ(siphash24(key, msg.substr(0, 15)), 0xa129ca6149be45e5u);
+    EXPECT_EQ(siphash24(key, msg), 0x958a324ceb064572u);
+    EXPECT_EQ(siphash13(key, std::string()), 0xabac0158050fc4dcu);
+    EXPECT_EQ(siphash13(key, msg.substr(0, 15)), 0xd320d86d2a519956u);
+    EXPECT_EQ(siphash13(key, msg), 0x9d199062b7bbb3a8u);
+
+    // mixed lengths keep the lanes refilling at different steps
+    const std::string data = test::pattern(5000);
+    std::vector<std::string_view> keys;
+    for (size_t i = 0; i < 200; ++i) {
+        keys.emplace_back(data.data() + i, (i * 37) % 71 + (i % 9 == 0 ? 300 : 0));
+    }
+    for (size_t n : {0, 1, 3, 4, 5, 17, 200}) {
+        std::vector<uint64_t> a(n), b(n);
+        siphash24_batch(key, keys.data(), n, a.data());
+        siphash13_batch(key, keys.data(), n, b.data());
+        for (size_t i = 0; i < n; ++i) {
+            EXPECT_EQ(a[i], siphash24(key, keys[i])) << n << ' ' << i;
+            EXPECT_EQ(b[i], siphash13(key, keys[i])) << n << ' ' << i;
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#include <memory>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <lcrypt/hex.h>
+#include <lcrypt/hmac.h>
+#include "common.h"
+
+using namespace lc;
+using test::hex;
+
+TEST(crypto, hmac_sha256) {
+    // RFC 4231 test cases 1, 2, 3, 4, 6 and 7
+    struct {
+        std::string key, msg, mac;
+    } cases[] = {
+        {std::string(20, '\x0b'), "Hi There",
+         "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7"},
+        {"Jefe", "what do ya want for nothing?",
+         "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843"},
+        {std::string(20, '\xaa'), std::string(50, '\xdd'),
+         "773ea91e36800e46854db8ebd09181a72959098b3ef8c122d9635514ced565fe"},
+        {hex_decode(std::string("0102030405060708090a0b0c0d0e0f10111213141516171819")),
+         std::string(50, '\xcd'), "82558a389a443c0ea4cc819899f2083a85f0faa3e578f8077a2e3ff46729665b"},
+        {std::string(131, '\xaa'), "Test Using Larger Than Block-Size Key - Hash Key First",
+         "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54"},
+        {std::string(131, '\xaa'),
+         "This is a test using a larger than block-size key and a larger than block-size data. The "
+         "key needs to be hashed before being used by the HMAC algorithm.",
+         "9b09ffa71b942fcb27635fbcd5b0e944bfdc63644f0713938a7f51535c3a35e2"},
+        {std::string(64, 'k'), "", "83026a325aaee70e36cfe607536aa1054104ad1077c36134810d4ccded1ccd3b"},
+        {"", "x", "4cbc96099a6467ce002461f10549b4898265ebe6188b45efacc44293516e62c4"},
+    };
+    for (auto& c : cases) {
+        hmac_sha256_key key(c.key);
+        const auto mac = key.sign(c.msg);
+        EXPECT_EQ(hex(mac), c.mac);
+        EXPECT_EQ(hmac_sha256(c.key.data(), c.key.size(), c.msg.data(), c.msg.size()), mac);
+        EXPECT_TRUE(key.verify(c.msg, mac));
+        auto bad = mac;
+        bad[31] ^= 1;
+        EXPECT_FALSE(key.verify(c.msg, bad));
+        EXPECT_FALSE(key.verify(c.msg.data(), c.msg.size(), mac.data(), 16));
+    }
+}
+
+TEST(crypto, hmac_sha256_batch) {
+    hmac_sha256_key key(std::string("webhook secret"));
+    const auto& msgs = test::boundary_messages();
+    const size_t n = msgs.size();
+    std::vector<sha256::digest_t> macs(n);
+    key.sign_batch(msgs.data(), n, macs.data());
+    for (size_t i = 0; i < n; ++i) {
+        EXPECT_EQ(macs[i], key.sign(msgs[i])) << i;
+    }
+    macs[5][0] ^= 0x80;
+    std::unique_ptr<bool[]> ok(new bool[n]);
+    key.verify_batch(msgs.data(), macs.data(), n, ok.get());
+    for (size_t i = 0; i < n; ++i) {
+        EXPECT_EQ(ok[i], i != 5) << i;
+    }
+}
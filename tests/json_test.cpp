@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+#include <lcrypt/json.h>
+
+using namespace lc;
+
+TEST(crypto, json) {
+    std::string a = "abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    std::string in_1  = a + "\"quoted\" back\\slash\ttab\nline\x01\x1f" + a + "\xE4\xB8\xAD";
+    std::string out_1 = a + "\\\"quoted\\\" back\\\\slash\\ttab\\nline\\u0001\\u001f" + a
+                        + "\xE4\xB8\xAD";
+
+    EXPECT_EQ(json_escape(a), a);
+    EXPECT_EQ(json_escape(in_1), out_1);
+    EXPECT_EQ(json_escape_size(in_1), out_1.size());
+    EXPECT_EQ(json_escape(""), "");
+    EXPECT_EQ(json_escape("\"\\\b\f\r"), "\\\"\\\\\\b\\f\\r");
+
+    EXPECT_EQ(json_unescape(a), a);
+    EXPECT_EQ(json_unescape(out_1), in_1);
+    EXPECT_EQ(json_unescape("\\/\\u00e9\\u4E2D"), "/\xC3\xA9\xE4\xB8\xAD");
+    EXPECT_EQ(json_unescape(a + "\\ud83d\\ude00" + a), a + "\xF0\x9F\x98\x80" + a);
+
+    for (size_t i = 0; i < in_1.size(); ++i) {
+        auto s = in_1.substr(i);
+        EXPECT_EQ(json_unescape(json_escape(s)), s);
+    }
+
+    try {
+        json_unescape(a + "\\x");
+        EXPECT_TRUE(false);
+    } catch (const input_error& e) {
+        EXPECT_EQ(e.offset(), a.size() + 1);
+    }
+    EXPECT_THROW(json_unescape("abc\\"), input_error);
+    EXPECT_THROW(json_unescape("\\u12G4"), input_error);
+    EXPECT_THROW(json_unescape("\\ud83d"), input_error);
+    EXPECT_THROW(json_unescape("\\ude00"), input_error);
+}
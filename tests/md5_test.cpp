@@ -0,0 +1,38 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <lcrypt/md5.h>
+#include "common.h"
+
+using namespace lc;
+using test::hex;
+
+TEST(crypto, md5) {
+    // RFC 1321 test suite
+    EXPECT_EQ(hex(md5::hash(std::string())), "d41d8cd98f00b204e9800998ecf8427e");
+    EXPECT_EQ(hex(md5::hash(std::string("a"))), "0cc175b9c0f1b6a831c399e269772661");
+    EXPECT_EQ(hex(md5::hash(std::string("abc"))), "900150983cd24fb0d6963f7d28e17f72");
+    EXPECT_EQ(hex(md5::hash(std::string("message digest"))), "f96b697d7cb7938d525a2f31aaf161d0");
+    EXPECT_EQ(hex(md5::hash(std::string("abcdefghijklmnopqrstuvwxyz"))),
+              "c3fcd3d76192e4007dfb496cca67e13b");
+    const std::string digits = "12345678901234567890123456789012345678901234567890123456789012345678901234567890";
+    EXPECT_EQ(hex(md5::hash(digits)), "57edf4a22be3c955ac49da2e2107b67a");
+
+    md5 h;
+    for (size_t step : {1, 7, 64, 80}) {
+        for (size_t i = 0; i < digits.size(); i += step) {
+            h.update(digits.data() + i, std::min(step, digits.size() - i));
+        }
+        EXPECT_EQ(hex(h.digest()), "57edf4a22be3c955ac49da2e2107b67a") << step;
+    }
+}
+
+TEST(crypto, md5_batch) {
+    const auto& msgs = test::boundary_messages();
+    std::vector<md5::digest_t> out(msgs.size());
+    md5_batch(msgs.data(), msgs.size(), out.data());
+    for (size_t i = 0; i < msgs.size(); ++i) {
+        EXPECT_EQ(out[i], md5::hash(msgs[i])) << i;
+    }
+}
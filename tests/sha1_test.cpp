@@ -0,0 +1,39 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <lcrypt/sha1.h>
+#include "common.h"
+
+using namespace lc;
+using test::hex;
+
+TEST(crypto, sha1) {
+    EXPECT_EQ(hex(sha1::hash(std::string())), "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+    EXPECT_EQ(hex(sha1::hash(std::string("abc"))), "a9993e364706816aba3e25717850c26c9cd0d89d");
+    const std::string two_blocks = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    EXPECT_EQ(hex(sha1::hash(two_blocks)), "84983e441c3bd26ebaae4aa1f95129e5e54670f1");
+    const std::string million(1000000, 'a');
+    EXPECT_EQ(hex(sha1::hash(million)), "34aa973cd4c4daa4f61eeb2bdbad27316534016f");
+
+    sha1 h;
+    for (size_t step : {1, 63, 64, 65, 1000}) {
+        for (size_t i = 0; i < million.size(); i += step) {
+            h.update(million.data() + i, std::min(step, million.size() - i));
+        }
+        EXPECT_EQ(h.digest(), sha1::hash(million)) << step;
+    }
+
+    // RFC 6455 section 1.3
+    EXPECT_EQ(sha1_base64(std::string("dGhlIHNhbXBsZSBub25jZQ==258EAFA5-E914-47DA-95CA-C5AB0DC85B11")),
+              "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=");
+}
+
+TEST(crypto, sha1_batch) {
+    const auto& msgs = test::boundary_messages();
+    std::vector<sha1::digest_t> out(msgs.size());
+    sha1_batch(msgs.data(), msgs.size(), out.data());
+    for (size_t i = 0; i < msgs.size(); ++i) {
+        EXPECT_EQ(out[i], sha1::hash(msgs[i])) << i;
+    }
+}
@@ -0,0 +1,47 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <lcrypt/sha256.h>
+#include "common.h"
+
+using namespace lc;
+using test::hex;
+
+TEST(crypto, sha256) {
+    // FIPS 180-4 examples
+    EXPECT_EQ(hex(sha256::hash(std::string())),
+              "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    EXPECT_EQ(hex(sha256::hash(std::string("abc"))),
+              "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    const std::string two_blocks = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    EXPECT_EQ(hex(sha256::hash(two_blocks)),
+              "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    const std::string million(1000000, 'a');
+    EXPECT_EQ(hex(sha256::hash(million)),
+              "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+
+    // any split of the input, and the context is reusable after digest()
+    sha256 h;
+    for (size_t step : {1, 3, 63, 64, 65, 1000}) {
+        for (size_t i = 0; i < million.size(); i += step) {
+            h.update(million.data() + i, std::min(step, million.size() - i));
+        }
+        EXPECT_EQ(h.digest(), sha256::hash(million)) << step;
+    }
+    h.update(std::string("ab")).update(std::string("c"));
+    EXPECT_EQ(hex(h.digest()), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+}
+
+TEST(crypto, sha256_batch) {
+    const auto& msgs = test::boundary_messages();
+    std::vector<sha256::digest_t> out(msgs.size());
+    sha256_batch(msgs.data(), msgs.size(), out.data());
+    for (size_t i = 0; i < msgs.size(); ++i) {
+        EXPECT_EQ(out[i], sha256::hash(msgs[i])) << i;
+    }
+    std::string_view abc = "abc";
+    sha256_batch(&abc, 1, out.data());
+    EXPECT_EQ(hex(out[0]), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    sha256_batch(nullptr, 0, nullptr);
+}
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include <lcrypt/hex.h>
 #include <lcrypt/str.h>
+#include <random>
 
 using namespace lc;
 using str_t = std::string;
@@ -48,6 +49,40 @@ TEST(crypto, string) {
     EXPECT_TRUE(str_ends_with("abc.txt", ".txt"));
 }
 
+TEST(crypto, string_icase) {
+    std::string s1 = "Content-Type";
+    std::string s2 = "content-type";
+    std::string s3 = "12345678901234567890123456789012Content-TYPE:abc/XYZ";
+    std::string s4 = "12345678901234567890123456789012content-type:ABC/xyz";
+
+    EXPECT_TRUE(str_iequals(s1, s2));
+    EXPECT_TRUE(str_iequals(s3, s4));
+    EXPECT_FALSE(str_iequals(s1, "content-typo"));
+    EXPECT_FALSE(str_iequals(s3, s4.substr(1)));
+    EXPECT_FALSE(str_iequals("@", "`"));
+    EXPECT_TRUE(str_istarts_with(s3, s4.substr(0, 40)));
+    EXPECT_TRUE(str_iends_with(s3, "ABC/xyz"));
+    EXPECT_FALSE(str_iends_with(s3, "ABC/xy"));
+
+    EXPECT_EQ(str_ifind(s3, "content-type"), 32);
+    EXPECT_EQ(str_ifind(s3, "C"), 32);
+    EXPECT_EQ(str_ifind(s3, "xyz"), s3.size() - 3);
+    EXPECT_EQ(str_ifind(s3, "ABC", 33), 45);
+    EXPECT_EQ(str_ifind(s3, "ab"), 45);
+    EXPECT_EQ(str_ifind(s3, "type;"), std::string_view::npos);
+    EXPECT_EQ(str_ifind(s3, ""), 0);
+    EXPECT_EQ(str_ifind("ab", "abc"), std::string_view::npos);
+
+    EXPECT_EQ(str_ihash(s1), str_ihash(s2));
+    EXPECT_EQ(str_ihash(s3), str_ihash(s4));
+    EXPECT_NE(str_ihash(s1), str_ihash(s3));
+
+    str_toupper_inplace(s3);
+    EXPECT_EQ(s3, "12345678901234567890123456789012CONTENT-TYPE:ABC/XYZ");
+    str_tolower_inplace(s3);
+    EXPECT_EQ(s3, "12345678901234567890123456789012content-type:abc/xyz");
+}
+
 TEST(crypto, pack) {
     EXPECT_EQ(hex_encode(str_pack("i2", 1)), "0100");
 
@@ -138,3 +173,567 @@ TEST(crypto, pack) {
         EXPECT_EQ(pos, r.size());
     } while (0);
 }
+
+TEST(crypto, pack_format) {
+    do {
+        std::string fmt = " >!8 b Xh i4 i8 c1 Xi8";
+        pack_format pf(fmt);
+        auto r = pf.pack(-12, 100, 200, "\xEC");
+        EXPECT_EQ(r, str_pack(fmt, -12, 100, 200, "\xEC"));
+        EXPECT_EQ((pf.unpack<int, int, int, std::string>(r)),
+                  (str_unpack<int, int, int, std::string>(fmt, r)));
+    } while (0);
+
+    do {
+        std::string fmt = ">!4 c3 c4 c2 z i4 c5 c2 Xi4 s2 <d f";
+        pack_format pf(fmt);
+        auto r = pf.pack("abc", "abcd", "xz", "hello", 5, "world", "xy", "len", 1.5, -2.5f);
+        EXPECT_EQ(r, str_pack(fmt, "abc", "abcd", "xz", "hello", 5, "world", "xy", "len", 1.5, -2.5f));
+        auto [a, b, c, d, e, f, g, h, i, j, pos] =
+            pf.unpack<str_t, str_t, str_t, str_t, int, str_t, str_t, str_t, double, float>(r);
+        EXPECT_EQ(a, "abc");
+        EXPECT_EQ(d, "hello");
+        EXPECT_EQ(e, 5);
+        EXPECT_EQ(g, "xy");
+        EXPECT_EQ(h, "len");
+        EXPECT_EQ(i, 1.5);
+        EXPECT_EQ(j, -2.5f);
+        EXPECT_EQ(pos, r.size());
+    } while (0);
+
+    do {
+        pack_format pf(" b b Xd b Xb x");
+        EXPECT_EQ(pf.ops().size(), 6u);
+        auto r = pf.pack(1, 2, 3);
+        EXPECT_EQ(hex_encode(r), "01020300");
+        EXPECT_EQ((pf.unpack<int, int, int>(r)), std::make_tuple(1, 2, 3, 4));
+    } while (0);
+
+    do {
+        std::string fmt = ">!4 b s2 Xi4 z c3 x";
+        pack_format pf(fmt);
+        auto r = str_pack(fmt, 1, "abc", "zz", "c");
+        EXPECT_EQ(str_pack_size(fmt, 1, "abc", "zz", "c"), r.size());
+        EXPECT_EQ(pf.size(1, "abc", "zz", "c"), r.size());
+
+        char buf[64];
+        memset(buf, 0xcc, sizeof(buf));
+        EXPECT_EQ(str_pack_into(buf, sizeof(buf), fmt, 1, "abc", "zz", "c"), r.size());
+        EXPECT_EQ(std::string_view(buf, r.size()), to_span(r));
+        memset(buf, 0xcc, sizeof(buf));
+        EXPECT_EQ(pf.pack_into(buf, r.size(), 1, "abc", "zz", "c"), r.size());
+        EXPECT_EQ(std::string_view(buf, r.size()), to_span(r));
+        EXPECT_THROW(str_pack_into(buf, r.size() - 1, fmt, 1, "abc", "zz", "c"), std::runtime_error);
+        EXPECT_THROW(pf.pack_into(buf, r.size() - 1, 1, "abc", "zz", "c"), std::runtime_error);
+
+        std::string out = "head";
+        EXPECT_EQ(str_pack_append(out, fmt, 1, "abc", "zz", "c"), r.size());
+        EXPECT_EQ(pf.pack_append(out, 1, "abc", "zz", "c"), r.size());
+        EXPECT_EQ(out, "head" + std::string(to_span(r)) + std::string(to_span(r)));
+        // a bad argument leaves the buffer as it was
+        const std::string before = out;
+        EXPECT_THROW(str_pack_append(out, "<i4 i4", 1, "abc"), std::runtime_error);
+        EXPECT_THROW(pack_format("<i4 i4").pack_append(out, 1, "abc"), std::runtime_error);
+        EXPECT_EQ(out, before);
+        EXPECT_THROW(str_pack_size(fmt, 1), std::runtime_error);
+    } while (0);
+
+    pack_format pf("<i4 z");
+    EXPECT_THROW(pf.pack(1), std::runtime_error);
+    EXPECT_THROW(pf.pack("abc", "abc"), std::runtime_error);
+    EXPECT_THROW((pf.unpack<int, std::string>(std::string_view("\1\0\0\0abc", 7))),
+                 std::runtime_error);
+    EXPECT_THROW((pf.unpack<int>(std::string_view("\1\0\0", 3))), std::runtime_error);
+    EXPECT_THROW(pack_format("!8 i3"), std::runtime_error);
+    EXPECT_THROW(pack_format("q"), input_error);
+}
+
+TEST(crypto, pack_view) {
+    std::string fmt = "<c3 s2 z B";
+    auto r          = str_pack(fmt, "abc", "hello", std::string(40, 'z'), 7);
+    auto sr         = std::string_view(r.data(), r.size());
+
+    auto [a, b, c, d, pos] = str_unpack<std::string_view, std::string_view, std::string_view, int>(fmt, sr);
+    EXPECT_EQ(a, "abc");
+    EXPECT_EQ(b, "hello");
+    EXPECT_EQ(c, std::string(40, 'z'));
+    EXPECT_EQ(d, 7);
+    EXPECT_EQ(pos, r.size());
+    EXPECT_EQ(a.data(), r.data());
+    EXPECT_EQ(c.data(), r.data() + 10);
+
+    pack_format pf(fmt);
+    auto t = pf.unpack<std::string_view, std::string_view, std::string_view, int>(sr);
+    EXPECT_EQ(t, std::make_tuple(a, b, c, d, pos));
+    EXPECT_EQ(std::get<1>(t).data(), b.data());
+
+    // unterminated 'z' stays inside the data
+    auto cut = sr.substr(0, 20);
+    EXPECT_THROW((str_unpack<std::string_view, std::string_view, std::string_view>(fmt, cut)),
+                 std::runtime_error);
+    EXPECT_THROW((pf.unpack<std::string_view, std::string_view, std::string_view>(cut)),
+                 std::runtime_error);
+    EXPECT_THROW((str_unpack<std::string, std::string>(fmt, sr.substr(0, 6))), std::runtime_error);
+    EXPECT_EQ(detail::find_nul("", 0), 0u);
+    EXPECT_EQ(detail::find_nul(r.data() + 10, 41), 40u);
+    EXPECT_EQ(detail::find_nul(r.data() + 10, 40), 40u);
+
+#if __cpp_nontype_template_args >= 201911L
+    auto u = str_unpack<"<c3 s2 z B", std::string_view, std::string_view, std::string_view, int>(sr);
+    EXPECT_EQ(u, std::make_tuple(a, b, c, d, pos));
+    EXPECT_EQ(std::get<2>(u).data(), c.data());
+    EXPECT_THROW((str_unpack<"<c3 s2 z", std::string_view, std::string_view, std::string_view>(cut)),
+                 std::runtime_error);
+#endif
+}
+
+TEST(crypto, pack_array) {
+    struct tick {
+        int64_t id;
+        double price;
+        float qty;
+        int side;
+        std::string_view sym;
+    };
+
+    for (const char* fmt : {">i8 d f b c3", "<i8 d f b c3", ">i3 !8 x d Xi8 f B c3"}) {
+        pack_format pf(fmt);
+        for (size_t n : {0, 1, 7, 300}) {
+            std::vector<tick> in(n);
+            std::vector<char> expect;
+            for (size_t i = 0; i < n; ++i) {
+                in[i] = {(int64_t)i * 7919 - 1000, i * 0.25, (float)i, (int)(i % 100), "ab"};
+                pf.pack_append(expect, in[i].id, in[i].price, in[i].qty, in[i].side, in[i].sym);
+            }
+            EXPECT_EQ(expect.size(), n * pf.record_size());
+
+            // array of structs
+            auto b = pf.pack_array(in.data(), n, &tick::id, &tick::price, &tick::qty, &tick::side,
+                                   &tick::sym);
+            EXPECT_EQ(b, expect);
+            std::string_view sb(b.data(), b.size());
+            std::vector<tick> out(n);
+            EXPECT_EQ(pf.unpack_array(sb, out.data(), n, &tick::id, &tick::price, &tick::qty,
+                                      &tick::side, &tick::sym),
+                      b.size());
+            for (size_t i = 0; i < n; ++i) {
+                EXPECT_EQ(out[i].id, in[i].id);
+                EXPECT_EQ(out[i].price, in[i].price);
+                EXPECT_EQ(out[i].qty, in[i].qty);
+                EXPECT_EQ(out[i].side, in[i].side);
+                EXPECT_EQ(out[i].sym, std::string_view("ab\0", 3));
+            }
+
+            // struct of arrays
+            std::vector<int64_t> ids(n);
+            std::vector<double> prices(n);
+            std::vector<double> qtys(n);
+            std::vector<uint8_t> sides(n);
+            std::vector<std::string> syms(n);
+            EXPECT_EQ(pf.unpack_array(sb, n, ids.data(), prices.data(), qtys.data(), sides.data(),
+                                      syms.data()),
+                      b.size());
+            for (size_t i = 0; i < n; ++i) {
+                EXPECT_EQ(ids[i], in[i].id);
+                EXPECT_EQ(prices[i], in[i].price);
+                EXPECT_EQ(qtys[i], in[i].qty);
+                EXPECT_EQ(sides[i], in[i].side);
+                EXPECT_EQ(syms[i], std::string("ab\0", 3));
+            }
+            EXPECT_EQ(pf.pack_array(n, ids.data(), prices.data(), qtys.data(), sides.data(),
+                                    syms.data()),
+                      expect);
+        }
+    }
+
+    // one column, straight copy or byte reversal
+    std::vector<uint32_t> v(1000);
+    for (size_t i = 0; i < v.size(); ++i) {
+        v[i] = (uint32_t)(i * 2654435761u);
+    }
+    for (const char* fmt : {"<I4", ">I4"}) {
+        pack_format pf(fmt);
+        auto b = pf.pack_array(v.size(), v.data());
+        EXPECT_EQ(std::get<0>(pf.unpack<uint32_t>(std::string_view(b.data() + 4 * 999, 4))), v[999]);
+        std::vector<uint32_t> r(v.size());
+        pf.unpack_array(std::string_view(b.data(), b.size()), r.size(), r.data());
+        EXPECT_EQ(r, v);
+    }
+
+    pack_format pf("<I2 d");
+    std::vector<int> a(2);
+    std::vector<double> d(2);
+    std::vector<char> buf(18);
+    std::string_view sb(buf.data(), buf.size());
+    EXPECT_THROW(pf.unpack_array(sb, 2, a.data()), std::runtime_error);
+    EXPECT_THROW(pf.unpack_array(sb, 2, a.data(), d.data(), d.data()), std::runtime_error);
+    EXPECT_THROW(pf.unpack_array(sb, 3, a.data(), d.data()), std::runtime_error);
+    EXPECT_EQ(pf.unpack_array(sb, 1, a.data(), d.data()), 10u);
+    EXPECT_THROW(pack_format("I2 z").record_size(), std::runtime_error);
+    EXPECT_THROW(pack_format("c2").pack_array(2, a.data()), std::runtime_error);
+}
+
+TEST(crypto, varint) {
+    EXPECT_EQ(zigzag_encode(0), 0u);
+    EXPECT_EQ(zigzag_encode(-1), 1u);
+    EXPECT_EQ(zigzag_encode(1), 2u);
+    EXPECT_EQ(zigzag_encode(INT64_MIN), UINT64_MAX);
+    EXPECT_EQ(zigzag_decode(UINT64_MAX - 1), INT64_MAX);
+    EXPECT_EQ(varint_size(0), 1u);
+    EXPECT_EQ(varint_size(300), 2u);
+    EXPECT_EQ(varint_size(UINT64_MAX), 10u);
+    EXPECT_EQ(hex_encode(varint_encode(std::vector<uint64_t>{1, 300, 0}.data(), 3)), "01ac0200");
+
+    // single byte runs, every size and the 10 byte maximum
+    std::vector<uint64_t> v;
+    std::string expect;
+    for (size_t i = 0; i < 2000; ++i) {
+        const uint64_t x = (i % 300 < 200) ? i % 128 : (uint64_t)1 << (i * 7 % 64);
+        v.push_back(i % 97 == 0 ? UINT64_MAX - i : x);
+        char buf[10];
+        expect.append(buf, detail::varint_write(buf, v.back()));
+    }
+    for (size_t n : {0, 1, 5, 200, 1000, 2000}) {
+        const auto enc = varint_encode(v.data(), n);
+        const auto ref = std::string_view(expect).substr(0, enc.size());
+        EXPECT_EQ(enc, ref);
+        EXPECT_EQ(varint_count(enc), n);
+        const auto dec = varint_decode(enc);
+        EXPECT_EQ(dec, std::vector<uint64_t>(v.begin(), v.begin() + n));
+    }
+
+    std::vector<int64_t> sv = {0, -1, 1, INT64_MIN, INT64_MAX, -300, 300, 5, -5, 7};
+    std::vector<uint64_t> zz(sv.size());
+    std::vector<int64_t> back(sv.size());
+    zigzag_encode(sv.data(), sv.size(), zz.data());
+    zigzag_decode(zz.data(), zz.size(), back.data());
+    EXPECT_EQ(back, sv);
+    EXPECT_EQ(zz[3], UINT64_MAX);
+
+    // mixed 1 and 2 byte varints, every continuation mask of 8 bytes, then up to 3 bytes
+    std::mt19937 rng(11);
+    std::vector<uint64_t> mix(5000);
+    std::string enc;
+    for (uint32_t maxsize : {2, 3}) {
+        for (auto& x : mix) {
+            x = rng() % (1u << (7 * (1 + rng() % maxsize)));
+        }
+        enc = varint_encode(mix.data(), mix.size());
+        EXPECT_EQ(varint_decode(enc), mix);
+    }
+
+    // truncated and longer than 10 bytes
+    std::string cut = varint_encode(v.data(), 300);
+    cut.back()      = (char)0x80;
+    EXPECT_THROW(varint_decode(cut), input_error);
+    EXPECT_THROW(varint_decode(std::string(11, (char)0xff)), input_error);
+    EXPECT_THROW(varint_decode(std::string(100, (char)0xff)), input_error);
+    // too long after short ones, `out` only holds the values counted
+    std::string bad = enc.substr(0, 7) + std::string(100, (char)0x80);
+    std::vector<uint64_t> few(varint_count(bad));
+    EXPECT_THROW(varint_decode(bad, few.data()), input_error);
+}
+
+TEST(crypto, pack_varint) {
+    const std::string fmt = "<V v S I2";
+    auto r = str_pack(fmt, 300, -2, "hello", 7);
+    EXPECT_EQ(hex_encode(r), "ac020305" + hex_encode(std::string("hello")) + "0700");
+    EXPECT_EQ(str_pack_size(fmt, 300, -2, "hello", 7), r.size());
+    std::vector<char> b;
+    str_pack_append(b, fmt, 300, -2, "hello", 7);
+    EXPECT_EQ(b, r);
+
+    auto t = str_unpack<uint64_t, int, std::string_view, int>(fmt, r);
+    EXPECT_EQ(t, std::make_tuple(300, -2, "hello", 7, (int)r.size()));
+
+    pack_format pf(fmt);
+    EXPECT_EQ(pf.pack(300, -2, "hello", 7), r);
+    EXPECT_EQ((pf.unpack<uint64_t, int, std::string, int>(r)),
+              std::make_tuple(300, -2, "hello", 7, (int)r.size()));
+    pack_format pv("V");
+    EXPECT_EQ(std::get<0>(pv.unpack<uint64_t>(pv.pack(UINT64_MAX))), UINT64_MAX);
+    EXPECT_THROW(pf.record_size(), std::runtime_error);
+
+    // cut inside the varint, the length and the string
+    for (size_t n : {1, 3, 6}) {
+        std::string_view cut(r.data(), n);
+        EXPECT_THROW((str_unpack<uint64_t, int, std::string_view>(fmt, cut)), std::runtime_error);
+        EXPECT_THROW((pf.unpack<uint64_t, int, std::string_view>(cut)), std::runtime_error);
+    }
+    EXPECT_THROW(str_unpack<uint64_t>("V", std::string(12, (char)0x80)), std::runtime_error);
+
+#if __cpp_nontype_template_args >= 201911L
+    EXPECT_EQ(str_pack<"<V v S I2">(300, -2, "hello", 7), r);
+    EXPECT_EQ((str_unpack<"<V v S I2", uint64_t, int, std::string_view, int>(r)),
+              std::make_tuple(300, -2, "hello", 7, (int)r.size()));
+    EXPECT_THROW((str_unpack<"<V v S", uint64_t, int, std::string_view>(std::string_view(r.data(), 6))),
+                 std::runtime_error);
+#endif
+}
+
+TEST(crypto, pack_reader) {
+    pack_format pf("<I2 i3 !4 d S z c3 V v s1 x");
+    std::string stream;
+    for (int i = 0; i < 20; ++i) {
+        auto m = pf.pack(i, -i * 1000, i * 0.25, std::string(i * 7, 'a' + i % 26),
+                         std::string(i, 'z'), "abc", i * 100000, -i, std::string(i % 3, 'q'));
+        stream.append(m.data(), m.size());
+    }
+
+    // random cuts, down to a segment per byte
+    std::mt19937 rng(7);
+    for (size_t maxseg : {1, 2, 5, 64, 4096}) {
+        std::vector<std::string_view> segs;
+        for (size_t pos = 0; pos < stream.size();) {
+            size_t n = std::min(1 + rng() % maxseg, stream.size() - pos);
+            segs.emplace_back(stream.data() + pos, n);
+            pos += n;
+        }
+
+        pack_reader rd(pf);
+        size_t next = 0;
+        size_t fed  = 0;
+        int i       = 0;
+        while (i < 20) {
+            int a, b;
+            double c;
+            int64_t v;
+            uint32_t u;
+            std::string s1;
+            std::string_view z, ch, s2;
+            if (!rd.unpack(a, b, c, s1, z, ch, u, v, s2)) {
+                ASSERT_GT(rd.missing(), 0);
+                ASSERT_EQ(rd.available(), fed - rd.consumed());
+                ASSERT_LT(next, segs.size());
+                fed += segs[next].size();
+                rd.feed(segs[next++]);
+                continue;
+            }
+            EXPECT_EQ(a, i);
+            EXPECT_EQ(b, -i * 1000);
+            EXPECT_EQ(c, i * 0.25);
+            EXPECT_EQ(s1, std::string(i * 7, 'a' + i % 26));
+            EXPECT_EQ(z, std::string(i, 'z'));
+            EXPECT_EQ(ch, "abc");
+            EXPECT_EQ(u, i * 100000u);
+            EXPECT_EQ(v, -i);
+            EXPECT_EQ(s2, std::string(i % 3, 'q'));
+            EXPECT_EQ(rd.missing(), 0);
+            EXPECT_EQ(rd.available(), fed - rd.consumed());
+            ++i;
+        }
+        EXPECT_EQ(rd.consumed(), stream.size());
+        EXPECT_EQ(rd.available(), 0);
+        EXPECT_EQ(next, segs.size());
+    }
+
+    // a length far beyond the fed bytes reports what is missing, without allocating it
+    pack_format ps("<s4");
+    pack_reader rd(ps);
+    const auto head = str_pack("<I4", 1u << 30);
+    rd.feed(std::string_view(head.data(), head.size()));
+    std::string s;
+    EXPECT_FALSE(rd.unpack(s));
+    EXPECT_EQ(rd.missing(), 1u << 30);
+    EXPECT_EQ(rd.consumed(), 0);
+    EXPECT_EQ(rd.available(), 4);
+
+    const auto m = ps.pack("hi");
+    pack_reader r2(ps);
+    r2.feed(std::string_view(m.data(), m.size()));
+    EXPECT_THROW(r2.unpack(s, s), std::runtime_error);
+}
+
+TEST(crypto, unpack_values) {
+    pack_format pf("<i3 I8 !4 d f s2 x z c2 V v S Xi4");
+    const auto b = pf.pack(-5, UINT64_MAX, 1.5, 0.25f, "ab", "zs", "cc", 300, -7, "vs");
+    const std::string_view data(b.data(), b.size());
+
+    std::vector<pack_value> vs;
+    EXPECT_EQ(unpack_values(pf, data, vs), b.size());
+    ASSERT_EQ(vs.size(), 10);
+    for (int k : {0, 1, 7, 8}) {
+        EXPECT_EQ(vs[k].type, pack_value::integer);
+    }
+    EXPECT_EQ(vs[0].as_integer(), -5);
+    EXPECT_EQ(vs[1].as_integer(), -1);
+    EXPECT_EQ(vs[2].type, pack_value::number);
+    EXPECT_EQ(vs[2].as_number(), 1.5);
+    EXPECT_EQ(vs[3].as_number(), 0.25);
+    EXPECT_EQ(vs[4].type, pack_value::string);
+    EXPECT_EQ(vs[4].as_string(), "ab");
+    EXPECT_EQ(vs[4].as_string().data(), data.data() + 26);
+    EXPECT_EQ(vs[5].as_string(), "zs");
+    EXPECT_EQ(vs[6].as_string(), "cc");
+    EXPECT_EQ(vs[7].as_integer(), 300);
+    EXPECT_EQ(vs[8].as_integer(), -7);
+    EXPECT_EQ(vs[9].as_string(), "vs");
+
+    // same fields as the typed unpack, the vector is reused
+    auto t = pf.unpack<int, uint64_t, double, float, std::string_view, std::string_view,
+                       std::string_view, int, int, std::string_view>(data);
+    EXPECT_EQ(std::get<10>(t), (int)b.size());
+    const auto cap = vs.capacity();
+    const auto b2 = str_pack("<i2 i2", 1, 2);
+    EXPECT_EQ(unpack_values(pack_format("<i2 i2"), std::string_view(b2.data(), b2.size()), vs), 4);
+    EXPECT_EQ(vs.size(), 2);
+    EXPECT_EQ(vs.capacity(), cap);
+    EXPECT_EQ(vs[1].as_integer(), 2);
+
+    EXPECT_THROW(unpack_values(pf, data.substr(0, b.size() - 1), vs), std::runtime_error);
+    EXPECT_THROW(unpack_values(pack_format("i9"), std::string(9, (char)1), vs), std::runtime_error);
+}
+
+TEST(crypto, pack_aggregate) {
+    struct quote {
+        uint32_t id;
+        int16_t side;
+        std::array<char, 2> venue;
+        double price;
+        int64_t qty;
+    };
+    struct order {
+        uint8_t flags;
+        float weight;
+        std::string name;
+        std::string_view note;
+        bool live;
+    };
+    static_assert(detail::aggregate_size<quote>() == 5);
+    static_assert(detail::aggregate_size<order>() == 5);
+    static_assert(detail::PackAggregate<quote>::raw);
+    static_assert(!detail::PackAggregate<order>::raw);
+
+    const quote q = {7, -1, {'N', 'Y'}, 101.5, -300};
+    auto b        = pack(q);
+    ASSERT_EQ(b.size(), sizeof(quote));
+    EXPECT_EQ(memcmp(b.data(), &q, sizeof(q)), 0);
+    EXPECT_EQ(b, str_pack("=!i4 i2 c2 d i8", 7, -1, "NY", 101.5, -300));
+    auto q2 = unpack<quote>(std::string_view(b.data(), b.size()));
+    EXPECT_EQ(memcmp(&q2, &q, sizeof(q)), 0);
+
+    // packed big-endian layout, member by member
+    b = pack(q, ">");
+    EXPECT_EQ(b, str_pack(">i4 i2 c2 d i8", 7, -1, "NY", 101.5, -300));
+    q2 = unpack<quote>(std::string_view(b.data(), b.size()), ">");
+    EXPECT_EQ(q2.id, q.id);
+    EXPECT_EQ(q2.side, q.side);
+    EXPECT_EQ(q2.venue, q.venue);
+    EXPECT_EQ(q2.price, q.price);
+    EXPECT_EQ(q2.qty, q.qty);
+    EXPECT_THROW(unpack<quote>(std::string_view(b.data(), b.size() - 1), ">"), std::runtime_error);
+    EXPECT_THROW(unpack<quote>(std::string_view(b.data(), sizeof(quote) - 1)), std::runtime_error);
+
+    // padding and strings follow the '!' alignment
+    const order o = {3, 0.5f, "abc", "note", true};
+    std::string sb;
+    const size_t n = pack_append(sb, o, "<!4");
+    EXPECT_EQ(n, sb.size());
+    auto expect = str_pack("<!4 B f s s B Xi4", 3, 0.5f, "abc", "note", 1);
+    EXPECT_EQ(std::vector<char>(sb.begin(), sb.end()), expect);
+    order o2;
+    EXPECT_EQ(unpack(sb, o2, "<!4"), sb.size());
+    EXPECT_EQ(o2.flags, 3);
+    EXPECT_EQ(o2.weight, 0.5f);
+    EXPECT_EQ(o2.name, "abc");
+    EXPECT_EQ(o2.note, "note");
+    EXPECT_EQ(o2.note.data(), sb.data() + 28);
+    EXPECT_TRUE(o2.live);
+    EXPECT_THROW(pack(o, "<i4"), std::runtime_error);
+
+    // the layouts are parsed once, a bad one is not kept
+    using agg = detail::PackAggregate<quote>;
+    EXPECT_EQ(&agg::layout("=!"), &agg::layout("=!"));
+    EXPECT_EQ(&agg::layout(">"), &agg::layout(">"));
+    EXPECT_NE(&agg::layout(">"), &agg::layout("<"));
+    EXPECT_THROW(pack(o, "<i4"), std::runtime_error);
+}
+
+#if __cpp_nontype_template_args >= 201911L
+TEST(crypto, pack_static) {
+    EXPECT_EQ(str_pack<"i2">(1), str_pack("i2", 1));
+    EXPECT_EQ((str_pack<" >!8 b Xh i4 i8 c1 Xi8">(-12, 100, 200, "\xEC")),
+              str_pack(" >!8 b Xh i4 i8 c1 Xi8", -12, 100, 200, "\xEC"));
+    EXPECT_EQ((str_pack<">!4 c3 c4 c2 z i4 c5 c2 Xi4 s2 <d f">("abc", "abcd", "xz", "hello", 5,
+                                                              "world", "xy", "len", 1.5, -2.5f)),
+              str_pack(">!4 c3 c4 c2 z i4 c5 c2 Xi4 s2 <d f", "abc", "abcd", "xz", "hello", 5,
+                       "world", "xy", "len", 1.5, -2.5f));
+    EXPECT_EQ(hex_encode(str_pack<" b b Xd b Xb x">(1, 2, 3)), "01020300");
+    EXPECT_EQ(hex_encode(str_pack<"<i16 >i12">(-2, 3)),
+              "feffffffffffffffffffffffffffffff000000000000000000000003");
+    EXPECT_EQ(hex_encode(str_pack<">I3 <I3 >f">(0x010203, 0x010203, 1.0)), "0102030302013f800000");
+
+    auto r = str_pack<"<!4 I4 H i8 c8 s2 d b">(42, 7, -1, "ticker", "payload", 3.25, -1);
+    EXPECT_EQ(r, str_pack("<!4 I4 H i8 c8 s2 d b", 42, 7, -1, "ticker", "payload", 3.25, -1));
+    auto [a, b, c, d, e, f, g, pos] =
+        str_unpack<"<!4 I4 H i8 c8 s2 d b", uint32_t, uint16_t, int64_t, str_t, str_t, double,
+                   int8_t>(r);
+    EXPECT_EQ(a, 42u);
+    EXPECT_EQ(b, 7);
+    EXPECT_EQ(c, -1);
+    EXPECT_EQ(d, std::string("ticker\0\0", 8));
+    EXPECT_EQ(e, "payload");
+    EXPECT_EQ(f, 3.25);
+    EXPECT_EQ(g, -1);
+    EXPECT_EQ(pos, r.size());
+
+    EXPECT_EQ((str_unpack<"<i16 >i12 >I3", int, int, int>(str_pack<"<i16 >i12 >I3">(-2, 3, 7))),
+              std::make_tuple(-2, 3, 7, 31));
+    EXPECT_EQ((str_unpack<"z B", str_t, int>(std::string_view("abc\0\xf7", 5))),
+              std::make_tuple(str_t("abc"), 247, 5));
+
+    EXPECT_THROW((str_unpack<"i4 i4", int, int>(std::string_view("\1\0\0\0", 4))),
+                 std::runtime_error);
+    EXPECT_THROW((str_unpack<"z", str_t>(std::string_view("abc", 3))), std::runtime_error);
+    EXPECT_THROW((str_unpack<"s1", str_t>(std::string_view("\5abc", 4))), std::runtime_error);
+    EXPECT_THROW((str_unpack<"<i9", int>(std::string_view("\1\0\0\0\0\0\0\0\1", 9))),
+                 std::runtime_error);
+    EXPECT_THROW(str_pack<"c2">(std::string("abc")), std::runtime_error);
+
+    char buf[32];
+    EXPECT_EQ((str_pack_size<">!4 b s2 Xi4 z c3 x">(1, "abc", "zz", "c")),
+              str_pack_size(">!4 b s2 Xi4 z c3 x", 1, "abc", "zz", "c"));
+    EXPECT_EQ((str_pack_into<">!4 b s2 Xi4 z c3 x">(buf, sizeof(buf), 1, "abc", "zz", "c")), 15u);
+    EXPECT_EQ(std::string_view(buf, 15), to_span(str_pack(">!4 b s2 Xi4 z c3 x", 1, "abc", "zz", "c")));
+    EXPECT_THROW((str_pack_into<"i8 i8">(buf, 15, 1, 2)), std::runtime_error);
+    std::vector<char> out;
+    str_pack_append<"<I2">(out, 1);
+    str_pack_append<"<I2">(out, 2);
+    EXPECT_EQ(hex_encode(out), "01000200");
+}
+#endif
+
+TEST(crypto, utf8) {
+    std::string ascii = "abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    std::string mixed = ascii + "\xC3\xA9t\xC3\xA9 \xE4\xB8\xAD\xE6\x96\x87 \xF0\x9F\x98\x80" + ascii;
+    std::u16string mixed16 = std::u16string(ascii.begin(), ascii.end()) + u"été 中文 "
+                             + u"\U0001F600" + std::u16string(ascii.begin(), ascii.end());
+
+    EXPECT_TRUE(utf8_is_valid(""));
+    EXPECT_TRUE(utf8_is_valid(ascii));
+    EXPECT_TRUE(utf8_is_valid(mixed));
+    for (size_t i = 0; i < mixed.size(); ++i) {
+        // every prefix that cuts a sequence is invalid at the lead byte
+        auto prefix = std::string_view(mixed).substr(0, i);
+        auto pos    = utf8_validate(prefix);
+        if (i < mixed.size() && (mixed[i] & 0xc0) == 0x80) {
+            EXPECT_NE(pos, std::string_view::npos);
+        } else {
+            EXPECT_EQ(pos, std::string_view::npos);
+        }
+    }
+
+    EXPECT_EQ(utf8_validate(ascii + "\x80" + ascii), ascii.size());
+    EXPECT_EQ(utf8_validate(ascii + "\xC0\xAF" + ascii), ascii.size());          // overlong
+    EXPECT_EQ(utf8_validate(ascii + "\xED\xA0\x80" + ascii), ascii.size());      // surrogate
+    EXPECT_EQ(utf8_validate(ascii + "\xF4\x90\x80\x80" + ascii), ascii.size());  // too large
+    EXPECT_EQ(utf8_validate(ascii + "\xE4\xB8" + ascii), ascii.size());          // too short
+    EXPECT_EQ(utf8_validate("ab\xE4\xB8"), 2);
+    EXPECT_EQ(utf8_validate(mixed + "\xFF"), mixed.size());
+
+    EXPECT_EQ(utf8_to_utf16(mixed), mixed16);
+    EXPECT_EQ(utf16_to_utf8(mixed16), mixed);
+    EXPECT_EQ(utf16_to_utf8(utf8_to_utf16(ascii)), ascii);
+    EXPECT_THROW(utf8_to_utf16(ascii + "\xC0\xAF"), input_error);
+    EXPECT_THROW(utf16_to_utf8(u"ab\xD800" "c"), input_error);
+}
@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <set>
+#include <gtest/gtest.h>
+#include <lcrypt/base64.h>
+#include <lcrypt/hex.h>
+#include <lcrypt/token.h>
+
+using namespace lc;
+
+static std::string base64url_decode(std::string s) {
+    std::replace(s.begin(), s.end(), '-', '+');
+    std::replace(s.begin(), s.end(), '_', '/');
+    s.append((4 - s.size() % 4) % 4, '=');
+    return base64_decode(s);
+}
+
+static const std::string b64url =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+// the bits of the last char past the `n` bytes are zero
+static bool canonical(const std::string& token, size_t n) {
+    if (n % 3 == 0) {
+        return true;
+    }
+    size_t v = b64url.find(token.back());
+    return (v & (n % 3 == 1 ? 0xf : 0x3)) == 0;
+}
+
+TEST(crypto, random_token) {
+    for (size_t n : {0, 1, 2, 3, 5, 16, 32, 33, 100, 1535, 1536, 1537, 5000}) {
+        auto hex = random_token_hex(n);
+        EXPECT_EQ(token_hex_size(n), hex.size());
+        EXPECT_EQ(std::string::npos, hex.find_first_not_of("0123456789abcdef"));
+        EXPECT_EQ(n, hex_decode(hex).size());
+
+        auto b64 = random_token_base64url(n);
+        EXPECT_EQ(token_base64url_size(n), b64.size());
+        EXPECT_EQ(std::string::npos, b64.find_first_not_of(b64url));
+        auto raw = base64url_decode(b64);
+        EXPECT_EQ(n, raw.size());
+        EXPECT_TRUE(canonical(b64, n));
+    }
+
+    std::set<std::string> seen;
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(seen.insert(random_token_base64url(16)).second);
+    }
+}
+
+TEST(crypto, random_tokens) {
+    for (size_t n : {1, 2, 3, 16, 20, 1537}) {
+        const size_t count = 300;
+        auto hex           = random_tokens_hex(count, n);
+        ASSERT_EQ(count * token_hex_size(n), hex.size());
+        EXPECT_EQ(std::string::npos, hex.find_first_not_of("0123456789abcdef"));
+
+        auto b64         = random_tokens_base64url(count, n);
+        const size_t len = token_base64url_size(n);
+        ASSERT_EQ(count * len, b64.size());
+        std::set<std::string> seen;
+        for (size_t i = 0; i < count; ++i) {
+            auto t   = b64.substr(i * len, len);
+            auto raw = base64url_decode(t);
+            EXPECT_EQ(n, raw.size());
+            EXPECT_TRUE(canonical(t, n));
+            if (n >= 16) {
+                EXPECT_TRUE(seen.insert(t).second);
+            }
+        }
+    }
+    EXPECT_TRUE(random_tokens_hex(0, 16).empty());
+    EXPECT_TRUE(random_tokens_base64url(16, 0).empty());
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <lcrypt/url.h>
+
+using namespace lc;
+
+TEST(crypto, url) {
+    std::string a = "abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ-._~";
+    std::string in_1  = a + "a b&c=d/e?f%\xE4\xB8\xAD" + a;
+    std::string out_1 = a + "a%20b%26c%3Dd%2Fe%3Ff%25%E4%B8%AD" + a;
+
+    EXPECT_EQ(url_encode(a), a);
+    EXPECT_EQ(url_encode(in_1), out_1);
+    EXPECT_EQ(url_encode_size(in_1), out_1.size());
+    EXPECT_EQ(url_encode("a b+c", true), "a+b%2Bc");
+    EXPECT_EQ(url_encode_size("a b+c", true), 7u);
+    EXPECT_EQ(url_encode(""), "");
+
+    EXPECT_EQ(url_decode(a), a);
+    EXPECT_EQ(url_decode(out_1), in_1);
+    EXPECT_EQ(url_decode("%e4%b8%ad+"), "\xE4\xB8\xAD+");
+    EXPECT_EQ(url_decode("a+b%2Bc", true), "a b+c");
+
+    for (size_t i = 0; i < in_1.size(); ++i) {
+        auto s = in_1.substr(i);
+        EXPECT_EQ(url_decode(url_encode(s)), s);
+        EXPECT_EQ(url_decode(url_encode(s, true), true), s);
+    }
+
+    // zero-copy when nothing changes
+    std::string buf;
+    EXPECT_EQ(url_encode(std::string_view(a), buf).data(), a.data());
+    EXPECT_EQ(url_decode(std::string_view(a), buf).data(), a.data());
+    EXPECT_EQ(url_encode(std::string_view(in_1), buf), out_1);
+    EXPECT_EQ(url_decode(std::string_view(out_1), buf), in_1);
+    EXPECT_EQ(url_encode(std::string_view("a b"), buf, true), "a+b");
+
+    try {
+        url_decode(a + "%4G");
+        EXPECT_TRUE(false);
+    } catch (const input_error& e) {
+        EXPECT_EQ(e.offset(), a.size() + 2);
+    }
+    EXPECT_THROW(url_decode("abc%"), input_error);
+    EXPECT_THROW(url_decode("abc%4"), input_error);
+    EXPECT_THROW(url_decode("%:0"), input_error);
+    EXPECT_THROW(url_decode(a + "%%41"), input_error);
+}
+
+TEST(crypto, url_query) {
+    std::string buf;
+    std::string q = "a=1&b=hello+world&&c&d=x%3Dy=z&e=&=f&" + std::string(80, 'k') + "=%E4%B8%AD";
+    auto params   = url_parse_query(q, buf);
+    ASSERT_EQ(params.size(), 7u);
+    EXPECT_EQ(params[0].first, "a");
+    EXPECT_EQ(params[0].second, "1");
+    EXPECT_EQ(params[1].first, "b");
+    EXPECT_EQ(params[1].second, "hello world");
+    EXPECT_EQ(params[2].first, "c");
+    EXPECT_EQ(params[2].second, "");
+    EXPECT_EQ(params[3].first, "d");
+    EXPECT_EQ(params[3].second, "x=y=z");
+    EXPECT_EQ(params[4].first, "e");
+    EXPECT_EQ(params[4].second, "");
+    EXPECT_EQ(params[5].first, "");
+    EXPECT_EQ(params[5].second, "f");
+    EXPECT_EQ(params[6].first, std::string(80, 'k'));
+    EXPECT_EQ(params[6].second, "\xE4\xB8\xAD");
+
+    // views into the query unless decoded
+    EXPECT_EQ(params[0].second.data(), q.data() + 2);
+    EXPECT_EQ(params[6].first.data(), q.data() + q.find('k'));
+    EXPECT_EQ(params[1].second.data(), buf.data());
+
+    EXPECT_TRUE(url_parse_query("", buf).empty());
+    EXPECT_TRUE(url_parse_query("&&", buf).empty());
+    EXPECT_THROW(url_parse_query("a=%zz", buf), input_error);
+}